@@ -145,4 +145,101 @@ Puzzle *readPuzzleFromFS(char *filepath, Bool fix) {
 
 	fclose(fp);
 	return res;
-}
\ No newline at end of file
+}
+
+Bool writeCompactBoard(FILE *fp, unsigned int dim, const unsigned int *values) {
+	unsigned int c;
+	int i = 0;
+
+	for (c = 0; c < dim * dim && i >= 0; c++) {
+		if (dim > maxCompactCharDim) {
+			i = fprintf(fp, c ? " %u" : "%u", values[c]);
+		} else if (!values[c]) {
+			i = fputc('.', fp);
+		} else {
+			i = fputc(values[c] < 10 ? '0' + values[c] : 'A' + values[c] - 10, fp);
+		}
+	}
+
+	return i >= 0 && fputc('\n', fp) != EOF;
+}
+
+Bool readCompactBoard(FILE *fp, unsigned int dim, unsigned int *values) {
+	unsigned int c;
+	int ch;
+
+	for (c = 0; c < dim * dim; c++) {
+		if (dim > maxCompactCharDim) {
+			if (fscanf(fp, "%u", values + c) != 1) {
+				return FALSE;
+			}
+		} else {
+			do {
+				ch = fgetc(fp);
+			} while (isspace(ch));
+			if (ch == '.') {
+				values[c] = 0;
+			} else if (isdigit(ch)) {
+				values[c] = ch - '0';
+			} else if (isupper(ch)) {
+				values[c] = ch - 'A' + 10;
+			} else {
+				return FALSE;
+			}
+		}
+		if (values[c] > dim) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+Bool readCompactRecord(FILE *fp, unsigned int dim, unsigned int *values) {
+	unsigned int c = 0, v, cellsNum = dim * dim;
+	Bool malformed = FALSE;
+	int ch;
+
+	do { /* the blank lines between the records */
+		ch = fgetc(fp);
+	} while (isspace(ch));
+	if (ch == EOF) {
+		return FALSE;
+	}
+
+	while (ch != EOF && ch != '\n') {
+		if (isspace(ch)) {
+			ch = fgetc(fp);
+			continue;
+		}
+		if (dim > maxCompactCharDim && isdigit(ch)) {
+			for (v = 0; isdigit(ch); ch = fgetc(fp)) {
+				if (v <= dim) { /* larger values are all out of range */
+					v = v * 10 + (ch - '0');
+				}
+			}
+		} else {
+			if (dim <= maxCompactCharDim && ch == '.') {
+				v = 0;
+			} else if (dim <= maxCompactCharDim && isdigit(ch)) {
+				v = ch - '0';
+			} else if (dim <= maxCompactCharDim && isupper(ch)) {
+				v = ch - 'A' + 10;
+			} else {
+				malformed = TRUE;
+				v = 0;
+			}
+			ch = fgetc(fp);
+		}
+		if (c < cellsNum) {
+			values[c++] = v > dim ? dim + 1 : v;
+		} else {
+			malformed = TRUE;
+		}
+	}
+
+	if (malformed || c < cellsNum) { /* an out of range value makes the board illegal */
+		values[0] = dim + 1;
+	}
+	return TRUE;
+}
@@ -4,9 +4,16 @@
  * This module contains all the IO operations of the program.
  */
 
+#include <stdio.h>
 #include "utils/Boolean.h"
 #include "dataStructures/Puzzle.h"
 
+/**
+ * The maximal n*m of the boards that are written in the compact format with a single
+ * char per cell: '.' for an empty cell, '1'-'9' for 1-9 and 'A'-'Z' for 10-35.
+ */
+#define maxCompactCharDim 35
+
 /**
  * This method writes a puzzle to the filesystem.
  *
@@ -38,4 +45,61 @@ Bool writePuzzleToFS(Puzzle *puzzle, char *filepath);
  */
 Puzzle *readPuzzleFromFS(char *filepath, Bool fix);
 
+/**
+ * This method writes a board in the compact format: a single line that contains the
+ * values of the cells, row by row. If dim ≤ maxCompactCharDim, every value is a single
+ * char (see maxCompactCharDim); otherwise the values are decimal and separated by spaces.
+ *
+ * Parameters:
+ * FILE *fp
+ * unsigned int dim - n*m
+ * const unsigned int *values - The values of the cells, 0 for an empty cell
+ *
+ * Preconditions:
+ * fp, values != 0
+ * [values] is an array of size dim^2
+ *
+ * Returns:
+ * TRUE iff the operation succeeded.
+ */
+Bool writeCompactBoard(FILE *fp, unsigned int dim, const unsigned int *values);
+
+/**
+ * This method reads a board that has been written by writeCompactBoard.
+ *
+ * Parameters:
+ * FILE *fp
+ * unsigned int dim - n*m
+ * unsigned int *values - The values of the cells would be stored here, 0 for an empty cell
+ *
+ * Preconditions:
+ * fp, values != 0
+ * [values] is an array of size dim^2
+ *
+ * Returns:
+ * TRUE iff a board of values in the range 0-dim has been read.
+ */
+Bool readCompactBoard(FILE *fp, unsigned int dim, unsigned int *values);
+
+/**
+ * This method reads a line of a file in the compact format (see writeCompactBoard) as a board,
+ * without rejecting it: a value that is out of the range 0-dim is stored as dim + 1, and a line
+ * that has a symbol that is not a value, or a wrong number of values, is stored as a board
+ * whose first value is dim + 1. So a record that is not a legal board is read as an
+ * illegal board, and the reading may go on with the next line.
+ *
+ * Parameters:
+ * FILE *fp
+ * unsigned int dim - n*m
+ * unsigned int *values - The values of the cells would be stored here, 0 for an empty cell
+ *
+ * Preconditions:
+ * fp, values != 0
+ * [values] is an array of size dim^2
+ *
+ * Returns:
+ * FALSE iff the end of the file has been reached before a record.
+ */
+Bool readCompactRecord(FILE *fp, unsigned int dim, unsigned int *values);
+
 #endif
\ No newline at end of file
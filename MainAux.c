@@ -1,10 +1,23 @@
 #include "MainAux.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <limits.h>
+#include <time.h>
+#include "IO.h"
 #include "Shared.h"
 #include "Strings.h"
+#include "algs/BatchGenerator.h"
+#include "algs/GridBank.h"
+#include "algs/GridValidator.h"
+#include "algs/ParallelCounter.h"
+#include "algs/SudokuAlgs.h"
+#include "dataStructures/Geometry.h"
 #include "dataStructures/Puzzle.h"
 #include "parser/Parser.h"
+#include "utils/MemAlloc.h"
+#include "utils/Strings.h"
 
 /**
  * The current game mode.
@@ -19,6 +32,8 @@ void mainLoop() {
 
 	initBundle();
 	bundle.markErrorsFlag = 1;
+	bundle.threadsNum = 0;
+	seedRng(&bundle.rng, (uint64_t) time(0));
 	initParser();
 
 	while (1) {
@@ -39,8 +54,215 @@ void mainLoop() {
 
 	destroyBundle();
 	freeParser();
+	freeGridBanks();
+	freeGeometries();
 }
 
 GameMode getCurrentGameMode() {
 	return currentMode;
 }
+
+/**
+ * This method parses a shard specification "k/N", where 1 ≤ k ≤ N.
+ *
+ * Returns:
+ * TRUE iff [spec] is a valid shard specification
+ */
+static Bool parseShardSpec(char *spec, unsigned int *shard, unsigned int *shardsNum) {
+	char *slash = strchr(spec, '/');
+	int k, n;
+
+	if (!slash) {
+		return FALSE;
+	}
+	*slash = '\0';
+	k = isUInteger(spec);
+	n = isUInteger(slash + 1);
+	*slash = '/';
+	if (!*spec || !slash[1] || k < 1 || n < k) {
+		return FALSE;
+	}
+
+	*shard = (unsigned int) k - 1;
+	*shardsNum = (unsigned int) n;
+	return TRUE;
+}
+
+/**
+ * This method parses a board dimensions specification "nxm", where n,m ≥ 1.
+ *
+ * Returns:
+ * TRUE iff [spec] is a valid dimensions specification
+ */
+static Bool parseDimsSpec(char *spec, unsigned int *n, unsigned int *m) {
+	char *x = strchr(spec, 'x');
+	int rows, cols;
+
+	if (!x) {
+		return FALSE;
+	}
+	*x = '\0';
+	rows = isUInteger(spec);
+	cols = isUInteger(x + 1);
+	*x = 'x';
+	if (!*spec || !x[1] || rows < 1 || cols < 1) {
+		return FALSE;
+	}
+
+	*n = (unsigned int) rows;
+	*m = (unsigned int) cols;
+	return TRUE;
+}
+
+/**
+ * This method counts the solutions of a shard of a puzzle file, see headlessMain.
+ */
+static int runShard(char *path, unsigned int shard, unsigned int shardsNum, unsigned int threadsNum) {
+	Puzzle *p = readPuzzleFromFS(path, FALSE);
+	uint64_t count;
+
+	if (!p) {
+		fprintf(stderr, "%s\n", errMsgIOExistOpeningFailed);
+		return EXIT_FAILURE;
+	}
+	if (!isPuzzleLegal(p)) {
+		fprintf(stderr, "%s\n", errMsgErroneousValues);
+		destroyPuzzle(p);
+		return EXIT_FAILURE;
+	}
+	if (p->n * p->m > maxMaskDim) {
+		fprintf(stderr, "%s\n", errMsgBoardTooLarge);
+		destroyPuzzle(p);
+		return EXIT_FAILURE;
+	}
+
+	count = shardBacktracking(p, shard, shardsNum, threadsNum);
+	freeGeometries();
+	printf(infoMsgShardSolutionsNum, shard + 1, shardsNum, count);
+
+	destroyPuzzle(p);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * This method generates a batch of puzzles into a file, see headlessMain.
+ */
+static int runGenerate(unsigned int n, unsigned int m, unsigned int clues, unsigned long count,
+		char *path, uint64_t seed, unsigned int threadsNum) {
+	Bool generated;
+	FILE *fp;
+
+	if (clues > n * m * n * m) {
+		fprintf(stderr, errMsgNotInRange, n * m * n * m);
+		return EXIT_FAILURE;
+	}
+	fp = fopen(path, "w");
+	if (!fp) {
+		fprintf(stderr, "%s\n", errMsgIOCreationModFailed);
+		return EXIT_FAILURE;
+	}
+
+	generated = generateBatch(n, m, clues, count, seed, threadsNum, fp);
+	freeGridBanks();
+	freeGeometries();
+	if (fclose(fp) || !generated) {
+		fprintf(stderr, "%s\n", errMsgIOCreationModFailed);
+		return EXIT_FAILURE;
+	}
+
+	printf(infoMsgPuzzlesWritten, count, path);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * The number of the cells that --validate reads and validates at once (in whole grids).
+ */
+#define validateChunkCells (1UL << 20)
+
+/**
+ * This method validates the grids of a batch file, see headlessMain.
+ */
+static int runValidate(char *path) {
+	unsigned int n, m, cellsNum;
+	unsigned int *grids;
+	unsigned long chunkLen, chunkGrids, gridsNum = 0, legalNum = 0;
+	FILE *fp = fopen(path, "r");
+
+	if (!fp) {
+		fprintf(stderr, "%s\n", errMsgIOExistOpeningFailed);
+		return EXIT_FAILURE;
+	}
+	/* the cells of a grid, (n*m)^2, and a value out of range, n*m + 1 (see readCompactRecord),
+	 * have to fit in an unsigned int */
+	if (fscanf(fp, "%u %u", &n, &m) != 2 || n < 1 || m < 1 || n > UINT_MAX / m || n * m > UINT_MAX / (n * m)) {
+		fprintf(stderr, "%s\n", errMsgIOExistOpeningFailed);
+		fclose(fp);
+		return EXIT_FAILURE;
+	}
+
+	cellsNum = n * m * n * m;
+	chunkGrids = validateChunkCells / cellsNum ? validateChunkCells / cellsNum : 1;
+	memAllocN(grids, unsigned int, chunkGrids * cellsNum);
+	do {
+		for (chunkLen = 0; chunkLen < chunkGrids
+			&& readCompactRecord(fp, n * m, grids + chunkLen * cellsNum); chunkLen++) {
+		}
+		legalNum += validateGrids(n, m, grids, chunkLen, 0);
+		gridsNum += chunkLen;
+	} while (chunkLen == chunkGrids);
+
+	memFree(grids);
+	if (ferror(fp)) {
+		fprintf(stderr, "%s\n", errMsgIOOpeningFailed);
+		fclose(fp);
+		return EXIT_FAILURE;
+	}
+	fclose(fp);
+	printf(infoMsgGridsLegal, legalNum, gridsNum);
+	return legalNum == gridsNum ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#undef validateChunkCells
+
+int headlessMain(int argc, char *argv[]) {
+	unsigned int shard, shardsNum, n, m, threadsNum = 0;
+	uint64_t seed = (uint64_t) time(0);
+	int k, argNum, value, clues = 0, count = 0;
+	Bool isShard = argc > 1 && !strcmp(argv[1], argShard);
+
+	if (argc == 3 && !strcmp(argv[1], argValidate)) {
+		return runValidate(argv[2]);
+	}
+
+	argNum = isShard ? 2 : 4; /* the positional arguments of the mode */
+	if (argc < 2 + argNum || (!isShard && strcmp(argv[1], argGenerate))
+		|| (isShard && !parseShardSpec(argv[2], &shard, &shardsNum))
+		|| (!isShard && (!parseDimsSpec(argv[2], &n, &m) || (clues = isUInteger(argv[3])) < 0
+			|| (count = isUInteger(argv[4])) < 0))) {
+		fprintf(stderr, "%s\n", errMsgHeadlessUsage);
+		return EXIT_FAILURE;
+	}
+
+	for (k = 2 + argNum; k < argc; k += 2) { /* the options */
+		if (k + 1 < argc && !strcmp(argv[k], argThreads)) {
+			value = isUInteger(argv[k + 1]);
+			threadsNum = (unsigned int) value;
+		} else if (k + 1 < argc && !isShard && !strcmp(argv[k], argSeed)) {
+			value = isUInteger64(argv[k + 1], &seed) ? 0 : -1;
+		} else {
+			value = -1;
+		}
+		if (value < 0) {
+			fprintf(stderr, "%s\n", errMsgHeadlessUsage);
+			return EXIT_FAILURE;
+		}
+	}
+	if (!threadsNum) {
+		threadsNum = onlineProcessorsNum();
+	}
+
+	if (isShard) {
+		return runShard(argv[3], shard, shardsNum, threadsNum);
+	}
+	return runGenerate(n, m, (unsigned int) clues, (unsigned long) count, argv[5], seed, threadsNum);
+}
@@ -68,4 +68,28 @@ GameMode getCurrentGameMode();
  */
 void mainLoop();
 
+/**
+ * This method runs a single job without the interactive game, as specified by the
+ * command line arguments:
+ * --shard k/N FILE [--threads T] - Count the solutions in the k-th of N shards of the
+ *		puzzle in FILE (1 ≤ k ≤ N), see shardBacktracking. The sum of the counts of
+ *		the N shards is the number of the solutions. The result is printed as a single
+ *		line: "shard k/N solutions C".
+ * --generate nxm CLUES COUNT FILE [--seed S] [--threads T] - Generate COUNT puzzles of n*m
+ *		blocks with CLUES clues each into FILE, see generateBatch. The seed S is any integer
+ *		below 2^64, the current time by default, and the same seed yields the same puzzles.
+ * --validate FILE - Validate the grids of FILE, in the format that --generate writes, see
+ *		validateGrids. A line that is not a grid of values in range counts as an illegal
+ *		grid (see readCompactRecord). The number of the legal grids is printed, and the exit
+ *		status is a success iff all of them are legal.
+ * The default number of the threads is the number of the online processors.
+ *
+ * Parameters:
+ * int argc, char *argv[] - The arguments of main
+ *
+ * Returns:
+ * The exit status of the program
+ */
+int headlessMain(int argc, char *argv[]);
+
 #endif
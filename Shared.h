@@ -7,6 +7,7 @@
 #include "dataStructures/Puzzle.h"
 #include "utils/Boolean.h"
 #include "dataStructures/Activity.h"
+#include "utils/Rng.h"
 
 /**
  * This struct bundles the variables that should be shared by
@@ -16,17 +17,27 @@ typedef struct {
 	Puzzle *puzzle;
 	Bool markErrorsFlag;
 	Activity *activity;
+
+	/**
+	 * The number of the threads that count solutions, 0 for a thread per online processor.
+	 */
+	unsigned int threadsNum;
+
+	/**
+	 * The generator of the random choices of the commands (see the "seed" command).
+	 */
+	Rng rng;
 } SharedBundle;
 
 /**
  * This method initializes the extern "bundle" variable,
- * but doesn't affect the markErrorsFlag variable.
+ * but doesn't affect the markErrorsFlag, threadsNum and rng variables.
  */
 void initBundle();
 
 /**
  * This method destroys the extern bundle variable,
- * but doesn't affect the markErrorsFlag variable.
+ * but doesn't affect the markErrorsFlag, threadsNum and rng variables.
  */
 void destroyBundle();
 
@@ -4,8 +4,15 @@
  * This header file defines all the strings in the program.
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 
+#define argShard "--shard"
+#define argThreads "--threads"
+#define argGenerate "--generate"
+#define argSeed "--seed"
+#define argValidate "--validate"
+
 #define cmdNameSolve "solve"
 #define cmdNameEdit "edit"
 #define cmdNameMarkErrors "mark_errors"
@@ -13,11 +20,19 @@
 #define cmdNameSet "set"
 #define cmdNameValidate "validate"
 #define cmdNameGenerate "generate"
+#define cmdNameGenerateUnique "generate_unique"
+#define cmdNameBuildBank "build_bank"
 #define cmdNameUndo "undo"
 #define cmdNameRedo "redo"
 #define cmdNameSave "save"
 #define cmdNameHint "hint"
 #define cmdNameNumSolutions "num_solutions"
+#define cmdNameCountResumable "count_resumable"
+#define cmdNameEnumerate "enumerate"
+#define cmdNameMarginals "marginals"
+#define cmdNameEstimateSolutions "estimate_solutions"
+#define cmdNameThreads "threads"
+#define cmdNameSeed "seed"
 #define cmdNameAutofill "autofill"
 #define cmdNameReset "reset"
 #define cmdNameExit "exit"
@@ -30,7 +45,20 @@
 #define infoMsgValidPuzzle "Validation passed: board is solvable"
 #define infoMsgInvalidPuzzle "Validation failed: board is unsolvable"
 #define infoMsgCellSet "Cell <%d,%d> set to %d\n"
-#define infoMsgSolutionsNum "Number of solutions: %d\n"
+#define infoMsgSolutionsNum "Number of solutions: %" PRIu64 "\n"
+#define infoMsgSolutionsNumAtLeast "Number of solutions: at least %" PRIu64 "\n"
+#define infoMsgResumedFrom "Resumed from the checkpoint in %s\n"
+#define infoMsgPuzzlesWritten "%lu puzzles were written to %s\n"
+#define infoMsgGridsLegal "%lu of %lu grids are legal\n"
+#define infoMsgSolutionsWritten "%lu solutions were written to %s\n"
+#define infoMsgMarginalsPartial "Marginals over the first %lu solutions:\n"
+#define infoMsgMarginalsCell "<%d,%d>:"
+#define infoMsgMarginalsValue " %d=%lu"
+#define infoMsgMarginalsForced "(forced)"
+#define infoMsgMarginalsForcedNum "Forced cells: %d\n"
+#define infoMsgSolutionsEstimate "Estimated number of solutions: %.4g (95%% confidence interval: %.4g - %.4g, %lu probes)\n"
+#define infoMsgShardSolutionsNum "shard %u/%u solutions %" PRIu64 "\n"
+#define infoMsgUniqueClues "The puzzle has a single solution with %u clues\n"
 #define infoMsgSingleSolution "This is a good board!"
 #define infoMsgMultipleSolutions "The puzzle has more than 1 solution, try to edit it further"
 #define infoMsgBoardReset "Board reset"
@@ -46,10 +74,22 @@
 #define errMsgIOCreationModFailed "Error: File cannot be created or modified"
 #define errMsgIOExistOpeningFailed "Error: File doesn't exist or cannot be opened"
 #define errMsgIOOpeningFailed "Error: File cannot be opened"
+#define errMsgNotCheckpoint "Error: %s exists and is not a checkpoint file\n"
 #define errMsgNonEmptyCell "Error: cell already contains a value"
 #define errMsgUnsolvablePuzzle "Error: board is unsolvable"
 #define errMsgNonEmptyBoard "Error: board is not empty"
 #define errMsgErroneousMarkErrorsVal "Error: the value should be 0 or 1"
+#define errMsgErroneousLimitVal "Error: the limit should be a positive integer"
+#define errMsgErroneousSamplesVal "Error: the number of probes should be a positive integer"
+#define errMsgErroneousIntervalVal "Error: the intervals should be non-negative integers, not both 0"
+#define errMsgErroneousSecondsVal "Error: the time budget should be a positive integer"
+#define errMsgErroneousGridsVal "Error: the number of grids should be a positive integer"
+#define errMsgBoardTooLarge "Error: the board is too large for this command"
+#define errMsgErroneousThreadsVal "Error: the value should be a non-negative integer"
+#define errMsgErroneousSeedVal "Error: the seed should be a non-negative integer"
+#define errMsgHeadlessUsage "Usage: sudoku-console --shard k/N FILE [--threads T]\n" \
+	"       sudoku-console --generate nxm CLUES COUNT FILE [--seed S] [--threads T]\n" \
+	"       sudoku-console --validate FILE"
 #define errMsgGenFailed "Error: puzzle generator failed"
 #define errMsgCannotRedo "Error: no moves to redo"
 #define errMsgCannotUndo "Error: no moves to undo"
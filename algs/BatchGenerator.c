@@ -0,0 +1,226 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "BatchGenerator.h"
+#include <assert.h>
+#include <pthread.h>
+#include <string.h>
+#include "SudokuAlgs.h"
+#include "../IO.h"
+#include "../utils/MemAlloc.h"
+
+/**
+ * The capacity of the queue of the writer, in puzzles per generator thread.
+ */
+#define slotsPerWorker 4
+
+/**
+ * This struct contains the data that is shared by the generator threads and the writer.
+ */
+typedef struct {
+	unsigned int n;
+	unsigned int m;
+	unsigned int clues;
+	uint64_t seed;
+
+	/**
+	 * The index of the next puzzle that should be generated, and the number of the puzzles.
+	 */
+	unsigned long next;
+	unsigned long count;
+
+	/**
+	 * A ring of slots of (n*m)^2 values: the generated puzzles that have not been written
+	 * yet are in the slots first, ..., first + len - 1 (mod slotsNum).
+	 */
+	unsigned int *slots;
+	unsigned int slotsNum;
+	unsigned int first;
+	unsigned int len;
+
+	/**
+	 * The number of the generator threads that have not finished yet.
+	 */
+	unsigned int activeWorkers;
+
+	/**
+	 * FALSE iff a puzzle could not be generated or written.
+	 */
+	Bool succeeded;
+
+	FILE *fp;
+
+	/**
+	 * The lock of all the fields above, except for the constant ones.
+	 */
+	pthread_mutex_t lock;
+	pthread_cond_t notFull;
+	pthread_cond_t notEmpty;
+} Batch;
+
+/**
+ * This struct defines a single generator thread.
+ */
+typedef struct {
+	Batch *batch;
+	Generator *gen;
+	pthread_t thread;
+} BatchWorker;
+
+/**
+ * This method clears the non-empty cells of a puzzle.
+ */
+static void clearPuzzle(Puzzle *p) {
+	unsigned int c, dim = p->n * p->m;
+
+	for (c = 0; c < dim * dim; c++) {
+		if (p->cells[c]) {
+			setBoardValue(p, c / dim, c % dim, 0);
+		}
+	}
+}
+
+/**
+ * This method is the main function of the generator threads.
+ */
+static void *runBatchWorker(void *arg) {
+	BatchWorker *worker = arg;
+	Batch *batch = worker->batch;
+	unsigned int cellsNum = batch->n * batch->m * batch->n * batch->m;
+	unsigned long index;
+	Bool generated, claimed;
+	Puzzle *p = createPuzzle(batch->n, batch->m);
+
+	while (TRUE) {
+		pthread_mutex_lock(&batch->lock);
+		index = batch->next;
+		claimed = index < batch->count && batch->succeeded;
+		if (claimed) {
+			batch->next++;
+		}
+		pthread_mutex_unlock(&batch->lock);
+		if (!claimed) {
+			break;
+		}
+
+		/* the seed of the puzzle [index]: the batch seed with its halves swapped, so every bit
+		 * of it counts, plus the index; seedRng scatters the consecutive seeds */
+		seedRng(&worker->gen->rng, ((batch->seed << 32) | (batch->seed >> 32)) + index);
+		clearPuzzle(p);
+		generated = generateRandomPuzzle(worker->gen, p, batch->clues);
+
+		pthread_mutex_lock(&batch->lock);
+		while (batch->len == batch->slotsNum) {
+			pthread_cond_wait(&batch->notFull, &batch->lock);
+		}
+		if (generated) {
+			memcpy(batch->slots + (batch->first + batch->len++) % batch->slotsNum * cellsNum,
+					p->cells, cellsNum * sizeof(unsigned int));
+			pthread_cond_signal(&batch->notEmpty);
+		} else {
+			batch->succeeded = FALSE;
+		}
+		pthread_mutex_unlock(&batch->lock);
+	}
+
+	pthread_mutex_lock(&batch->lock);
+	batch->activeWorkers--;
+	pthread_cond_signal(&batch->notEmpty);
+	pthread_mutex_unlock(&batch->lock);
+
+	destroyPuzzle(p);
+	return 0;
+}
+
+/**
+ * This method is the main function of the writer thread. The writing is done
+ * outside of the lock, so the generator threads are not blocked meanwhile.
+ */
+static void *runBatchWriter(void *arg) {
+	Batch *batch = arg;
+	unsigned int dim = batch->n * batch->m;
+	unsigned int *values;
+	Bool written = TRUE;
+
+	pthread_mutex_lock(&batch->lock);
+	while (TRUE) {
+		while (!batch->len && batch->activeWorkers) {
+			pthread_cond_wait(&batch->notEmpty, &batch->lock);
+		}
+		if (!batch->len) {
+			break;
+		}
+
+		values = batch->slots + batch->first * dim * dim;
+		pthread_mutex_unlock(&batch->lock);
+		if (written) {
+			written = writeCompactBoard(batch->fp, dim, values);
+		}
+		pthread_mutex_lock(&batch->lock);
+
+		batch->first = (batch->first + 1) % batch->slotsNum;
+		batch->len--;
+		if (!written) {
+			batch->succeeded = FALSE;
+		}
+		pthread_cond_signal(&batch->notFull);
+	}
+	pthread_mutex_unlock(&batch->lock);
+
+	return 0;
+}
+
+Bool generateBatch(unsigned int n, unsigned int m, unsigned int clues, unsigned long count,
+		uint64_t seed, unsigned int threadsNum, FILE *fp) {
+	unsigned int k, dim = n * m;
+	pthread_t writer;
+	BatchWorker *workers;
+	Batch batch;
+
+	assert(clues <= dim * dim && threadsNum >= 1);
+
+	batch.n = n;
+	batch.m = m;
+	batch.clues = clues;
+	batch.seed = seed;
+	batch.next = 0;
+	batch.count = count;
+	batch.slotsNum = slotsPerWorker * threadsNum;
+	batch.first = 0;
+	batch.len = 0;
+	batch.activeWorkers = threadsNum;
+	batch.succeeded = fprintf(fp, "%u %u\n", n, m) > 0;
+	batch.fp = fp;
+	memAllocN(batch.slots, unsigned int, batch.slotsNum * dim * dim);
+	pthread_mutex_init(&batch.lock, 0);
+	pthread_cond_init(&batch.notFull, 0);
+	pthread_cond_init(&batch.notEmpty, 0);
+
+	memAllocN(workers, BatchWorker, threadsNum);
+	for (k = 0; k < threadsNum; k++) { /* the generators read the bank before the threads start */
+		workers[k].batch = &batch;
+		workers[k].gen = createGenerator(n, m, seed);
+	}
+	for (k = 0; k < threadsNum; k++) {
+		if (pthread_create(&workers[k].thread, 0, runBatchWorker, workers + k)) {
+			fatalError("pthread_create");
+		}
+	}
+	if (pthread_create(&writer, 0, runBatchWriter, &batch)) {
+		fatalError("pthread_create");
+	}
+
+	for (k = 0; k < threadsNum; k++) {
+		pthread_join(workers[k].thread, 0);
+		destroyGenerator(workers[k].gen);
+	}
+	pthread_join(writer, 0);
+
+	pthread_mutex_destroy(&batch.lock);
+	pthread_cond_destroy(&batch.notFull);
+	pthread_cond_destroy(&batch.notEmpty);
+	memFree(batch.slots);
+	memFree(workers);
+	return batch.succeeded;
+}
+
+#undef slotsPerWorker
@@ -0,0 +1,40 @@
+#ifndef __ALGS_BATCHGENERATOR_H
+#define __ALGS_BATCHGENERATOR_H
+/**
+ * This module generates many puzzles into a single file, with several threads.
+ * Every generator thread has its own Generator (random state and scratch memory), and hands
+ * its puzzles to a single writer thread through a bounded queue. The writer writes the
+ * puzzles in the order in which they are completed, so a slow puzzle never holds back
+ * the others.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "../utils/Boolean.h"
+
+/**
+ * This method generates puzzles (see generateRandomPuzzle) and writes them to a file:
+ * a line "n m", followed by a puzzle per line in the compact format of writeCompactBoard.
+ * The random state of every puzzle is derived from [seed] and from the index of the puzzle,
+ * so the same seed yields the same puzzles for any number of threads, up to the order of the lines.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * unsigned int clues - The number of the non-empty cells of every puzzle
+ * unsigned long count - The number of the puzzles
+ * uint64_t seed
+ * unsigned int threadsNum - The number of the generator threads
+ * FILE *fp - The output file
+ *
+ * Preconditions:
+ * fp != 0
+ * clues ≤ (n*m)^2
+ * threadsNum ≥ 1
+ *
+ * Returns:
+ * TRUE iff all the puzzles have been generated and written.
+ */
+Bool generateBatch(unsigned int n, unsigned int m, unsigned int clues, unsigned long count,
+		uint64_t seed, unsigned int threadsNum, FILE *fp);
+
+#endif
@@ -0,0 +1,344 @@
+#include "CPSolver.h"
+#include <assert.h>
+#include "../utils/MemAlloc.h"
+
+CPEngine *createCPEngine(unsigned int n, unsigned int m) {
+	unsigned int dim = n * m;
+	CPEngine *memAlloc(engine, CPEngine);
+
+	engine->n = n;
+	engine->m = m;
+	engine->dim = dim;
+	engine->cellsNum = dim * dim;
+	engine->words = bitsetWords(dim);
+	engine->geometry = getGeometry(n, m);
+	engine->emptyCnt = engine->cellsNum;
+	engine->queueLen = 0;
+	engine->trailLen = 0;
+	engine->rng = 0;
+	engine->nodesLimit = 0;
+	engine->stats.nodes = 0;
+	engine->stats.backtracks = 0;
+	memAllocN(engine->value, unsigned int, engine->cellsNum);
+	memAllocN(engine->full, ValueMask, engine->words);
+	memAllocN(engine->cand, ValueMask, engine->cellsNum * engine->words);
+	memAllocN(engine->queue, unsigned int, engine->cellsNum);
+	/* a cell loses each of its candidates at most once, and is assigned at most once */
+	memAllocN(engine->trail, CPTrailEntry, engine->cellsNum * (dim + engine->words));
+	memAllocN(engine->frames, CPFrame, engine->cellsNum);
+	fillBitset(engine->full, dim);
+
+	return engine;
+}
+
+void destroyCPEngine(CPEngine *engine) {
+	memFree(engine->value);
+	memFree(engine->full);
+	memFree(engine->cand);
+	memFree(engine->queue);
+	memFree(engine->trail);
+	memFree(engine->frames);
+	memFree(engine);
+}
+
+/**
+ * This method records the value of a cell and the word w of its candidates on the trail.
+ */
+static void saveCell(CPEngine *engine, unsigned int c, unsigned int w) {
+	CPTrailEntry *entry = engine->trail + engine->trailLen++;
+	entry->cell = c;
+	entry->value = engine->value[c];
+	entry->word = w;
+	entry->cand = engine->cand[w * engine->cellsNum + c];
+}
+
+/**
+ * This method assigns the value v to the empty cell c, and queues it for propagation.
+ */
+static void assignCell(CPEngine *engine, unsigned int c, unsigned int v) {
+	unsigned int w;
+
+	assert(!engine->value[c]);
+	if (engine->words == 1) { /* the single-word fast path */
+		saveCell(engine, c, 0);
+	} else {
+		for (w = 0; w < engine->words; w++) {
+			saveCell(engine, c, w);
+			engine->cand[w * engine->cellsNum + c] = 0;
+		}
+	}
+	engine->value[c] = v;
+	engine->cand[bitsetWord(v) * engine->cellsNum + c] = bitsetBit(v);
+	engine->emptyCnt--;
+	engine->queue[engine->queueLen++] = c;
+}
+
+/**
+ * This method undoes the changes on the trail until its length is [mark].
+ */
+static void undoTrail(CPEngine *engine, unsigned int mark) {
+	CPTrailEntry *entry;
+	while (engine->trailLen > mark) {
+		entry = engine->trail + --engine->trailLen;
+		if (!entry->value && engine->value[entry->cell]) {
+			engine->emptyCnt++;
+		}
+		engine->value[entry->cell] = entry->value;
+		engine->cand[entry->word * engine->cellsNum + entry->cell] = entry->cand;
+	}
+}
+
+/**
+ * This method checks the candidates of the empty cell c after a value has been removed
+ * from them: it assigns the cell if a single candidate is left.
+ *
+ * Returns:
+ * FALSE iff no candidate is left
+ */
+static Bool checkCell(CPEngine *engine, unsigned int c) {
+	unsigned int w, single = 0;
+	ValueMask cand;
+
+	if (engine->words == 1) { /* the single-word fast path */
+		cand = engine->cand[c];
+		if (cand & (cand - 1)) {
+			return TRUE;
+		}
+		if (!cand) {
+			return FALSE;
+		}
+		assignCell(engine, c, lowestValue(cand));
+		return TRUE;
+	}
+	for (w = 0; w < engine->words; w++) {
+		cand = engine->cand[w * engine->cellsNum + c];
+		if (cand) {
+			if (single || (cand & (cand - 1))) { /* more than 1 left */
+				return TRUE;
+			}
+			single = w * maxMaskDim + lowestValue(cand);
+		}
+	}
+	if (!single) {
+		return FALSE;
+	}
+	assignCell(engine, c, single);
+	return TRUE;
+}
+
+/**
+ * This method removes the values of the queued cells from the candidates of their peers,
+ * assigns the cells that are left with a single candidate (naked singles) and the values
+ * that are left with a single cell in a unit (hidden singles), until a fixpoint is reached.
+ *
+ * Returns:
+ * FALSE iff a contradiction has been found
+ */
+static Bool propagate(CPEngine *engine) {
+#define fail engine->queueLen = 0; return FALSE
+
+	unsigned int dim = engine->dim, words = engine->words, peersNum = engine->geometry->peersNum;
+	unsigned int c, q, k, u, w;
+	const unsigned int *peers = engine->geometry->peers, *units = engine->geometry->units, *unit;
+	const unsigned int *value = engine->value;
+	const ValueMask *full = engine->full;
+	ValueMask *plane, *cand;
+	ValueMask bit, once, twice, placed, hidden;
+	Bool changed = TRUE;
+
+	while (changed) {
+		while (engine->queueLen > 0) { /* naked singles */
+			c = engine->queue[--engine->queueLen];
+			w = bitsetWord(value[c]);
+			bit = bitsetBit(value[c]);
+			plane = engine->cand + w * engine->cellsNum;
+			for (k = 0; k < peersNum; k++) {
+				q = peers[c * peersNum + k];
+				cand = plane + q;
+				if (*cand & bit) {
+					if (value[q]) {
+						fail;
+					}
+					saveCell(engine, q, w);
+					*cand &= ~bit;
+					if (!(*cand & (*cand - 1)) && !checkCell(engine, q)) { /* at most 1 left in the word */
+						fail;
+					}
+				}
+			}
+		}
+
+		changed = FALSE;
+		for (u = 0; u < 3 * dim; u++) { /* hidden singles */
+			unit = units + u * dim;
+			for (w = 0; w < words; w++) {
+				plane = engine->cand + w * engine->cellsNum;
+				once = 0;
+				twice = 0;
+				placed = 0;
+				for (k = 0; k < dim; k++) {
+					c = unit[k];
+					if (value[c]) {
+						placed |= plane[c];
+					} else {
+						twice |= once & plane[c];
+						once |= plane[c];
+					}
+				}
+				if ((once | placed) != full[w]) { /* some value has no place in the unit */
+					fail;
+				}
+				for (hidden = once & ~twice & ~placed; hidden; hidden &= ~bit) {
+					bit = hidden & (~hidden + 1);
+					for (k = 0; k < dim; k++) {
+						c = unit[k];
+						if (!value[c] && (plane[c] & bit)) {
+							break;
+						}
+					}
+					if (k == dim) { /* the cell has been assigned another hidden single */
+						fail;
+					}
+					assignCell(engine, c, w * maxMaskDim + lowestValue(bit));
+					changed = TRUE;
+				}
+			}
+		}
+	}
+
+	return TRUE;
+#undef fail
+}
+
+Bool loadCPEngine(CPEngine *engine, Puzzle *p) {
+	unsigned int c;
+
+	assert(p->n == engine->n && p->m == engine->m);
+	engine->trailLen = 0;
+	engine->queueLen = 0;
+	engine->emptyCnt = engine->cellsNum;
+	for (c = 0; c < engine->cellsNum * engine->words; c++) {
+		engine->cand[c] = engine->full[c / engine->cellsNum];
+	}
+	for (c = 0; c < engine->cellsNum; c++) {
+		engine->value[c] = 0;
+	}
+	for (c = 0; c < engine->cellsNum; c++) {
+		if (p->cells[c]) {
+			assignCell(engine, c, p->cells[c]);
+		}
+	}
+
+	return propagate(engine);
+}
+
+Bool excludeCPValue(CPEngine *engine, unsigned int c, unsigned int v) {
+	if (engine->value[c]) {
+		return engine->value[c] != v;
+	}
+
+	saveCell(engine, c, bitsetWord(v));
+	engine->cand[bitsetWord(v) * engine->cellsNum + c] &= ~bitsetBit(v);
+	return checkCell(engine, c) && propagate(engine);
+}
+
+/**
+ * This method returns an empty cell with the minimal number of candidates.
+ * Ties are broken in favour of the cell with the most empty peers, which constrains
+ * the rest of the board the most.
+ *
+ * Preconditions:
+ * engine->emptyCnt > 0
+ */
+static unsigned int chooseCell(CPEngine *engine) {
+	unsigned int c, k, cnt, deg, best = 0, bestCnt = engine->dim + 1, bestDeg = 0;
+	unsigned int peersNum = engine->geometry->peersNum;
+	const unsigned int *peer;
+
+	for (c = 0; c < engine->cellsNum; c++) {
+		if (!engine->value[c]) {
+			cnt = countBitset(engine->cand + c, engine->words, engine->cellsNum);
+			if (cnt <= bestCnt) {
+				deg = 0;
+				peer = engine->geometry->peers + c * peersNum;
+				for (k = 0; k < peersNum; k++) {
+					if (!engine->value[peer[k]]) {
+						deg++;
+					}
+				}
+				if (cnt < bestCnt || deg > bestDeg) {
+					best = c;
+					bestCnt = cnt;
+					bestDeg = deg;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+Bool searchCPEngine(CPEngine *engine) {
+	unsigned int depth = 0, start = engine->trailLen, cnt, v;
+	CPFrame *frame;
+
+	engine->stats.nodes = 0;
+	engine->stats.backtracks = 0;
+
+	while (engine->emptyCnt > 0) {
+		frame = engine->frames + depth++;
+		frame->trailMark = engine->trailLen;
+		frame->cell = chooseCell(engine);
+
+		while (TRUE) { /* try the values of the deepest frame until one of them propagates */
+			frame = engine->frames + depth - 1;
+			undoTrail(engine, frame->trailMark);
+			cnt = countBitset(engine->cand + frame->cell, engine->words, engine->cellsNum);
+			if (!cnt) { /* all the values of the cell have been tried */
+				if (--depth == 0) {
+					undoTrail(engine, start);
+					return FALSE;
+				}
+				engine->stats.backtracks++;
+				continue;
+			}
+
+			if (engine->nodesLimit && engine->stats.nodes == engine->nodesLimit) {
+				undoTrail(engine, start);
+				return FALSE;
+			}
+
+			v = nthBitsetValue(engine->cand + frame->cell, engine->words, engine->cellsNum,
+					engine->rng ? rngBelow(engine->rng, cnt) : 0);
+			saveCell(engine, frame->cell, bitsetWord(v)); /* v is not tried again */
+			engine->cand[bitsetWord(v) * engine->cellsNum + frame->cell] &= ~bitsetBit(v);
+			frame->trailMark = engine->trailLen;
+			engine->stats.nodes++;
+			assignCell(engine, frame->cell, v);
+			if (propagate(engine)) {
+				break;
+			}
+			engine->stats.backtracks++;
+		}
+	}
+
+	return TRUE;
+}
+
+Bool CPSolver(Puzzle *p, CPStats *stats) {
+	unsigned int c, dim = p->n * p->m;
+	Bool ret;
+	CPEngine *engine = createCPEngine(p->n, p->m);
+
+	ret = loadCPEngine(engine, p) && searchCPEngine(engine);
+	if (ret) {
+		for (c = 0; c < engine->cellsNum; c++) {
+			setBoardValue(p, c / dim, c % dim, engine->value[c]);
+		}
+	}
+	if (stats) {
+		*stats = engine->stats;
+	}
+
+	destroyCPEngine(engine);
+	return ret;
+}
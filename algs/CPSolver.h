@@ -0,0 +1,265 @@
+#ifndef __ALGS_CPSOLVER_H
+#define __ALGS_CPSOLVER_H
+/**
+ * This module comprises a constraint propagation based sudoku solver.
+ * Every empty cell keeps a mask of its candidates. Assignments are propagated
+ * to the peers of the cell (naked singles) and to the units (hidden singles),
+ * and the search branches on a cell with the minimum remaining values.
+ * Every change is recorded on a trail, so backtracking is done in place and
+ * the search does not allocate memory after the engine has been created.
+ * The candidates are bitsets (see Bitset), so the engine solves boards of any size.
+ */
+
+#include "../dataStructures/Geometry.h"
+#include "../dataStructures/Puzzle.h"
+#include "../utils/Bitset.h"
+#include "../utils/Rng.h"
+
+/**
+ * This struct contains the statistics of a single search.
+ */
+typedef struct {
+
+	/**
+	 * The number of the branching decisions (values that were tried).
+	 */
+	unsigned long nodes;
+
+	/**
+	 * The number of the decisions that led to a contradiction and were undone.
+	 */
+	unsigned long backtracks;
+} CPStats;
+
+/**
+ * This struct records a single change in the state of the engine,
+ * in order to undo it.
+ */
+typedef struct {
+
+	/**
+	 * The index of the cell (x * (n*m) + y).
+	 */
+	unsigned int cell;
+
+	/**
+	 * The value of the cell before the change.
+	 */
+	unsigned int value;
+
+	/**
+	 * The index of the word of the candidates of the cell that has been changed.
+	 */
+	unsigned int word;
+
+	/**
+	 * That word before the change.
+	 */
+	ValueMask cand;
+} CPTrailEntry;
+
+/**
+ * This struct defines a branching point of the search.
+ * A value that has been tried is removed from the candidates of the cell below
+ * [trailMark], so the candidates of the cell are the values that have not been tried yet.
+ */
+typedef struct {
+
+	/**
+	 * The length of the trail before the current value of the cell was assigned.
+	 */
+	unsigned int trailMark;
+
+	/**
+	 * The index of the cell.
+	 */
+	unsigned int cell;
+} CPFrame;
+
+/**
+ * This struct defines a constraint propagation engine for boards of a certain shape.
+ */
+typedef struct {
+
+	/**
+	 * The number of rows in each block.
+	 */
+	unsigned int n;
+
+	/**
+	 * The number of columns in each block.
+	 */
+	unsigned int m;
+
+	/**
+	 * n*m
+	 */
+	unsigned int dim;
+
+	/**
+	 * The number of the cells, dim^2.
+	 */
+	unsigned int cellsNum;
+
+	/**
+	 * The number of the empty cells.
+	 */
+	unsigned int emptyCnt;
+
+	/**
+	 * The value of each cell, 0 if it is empty.
+	 */
+	unsigned int *value;
+
+	/**
+	 * The number of the words of a set of candidates, bitsetWords(dim).
+	 */
+	unsigned int words;
+
+	/**
+	 * The set of all the values, 1, ..., dim.
+	 */
+	ValueMask *full;
+
+	/**
+	 * The candidates of each cell, as bitsets of [words] words stored word by word:
+	 * the word w of the candidates of the cell c is cand[w * cellsNum + c], so an engine
+	 * of a single word indexes cand[c]. The candidates of a non-empty cell contain only its value.
+	 */
+	ValueMask *cand;
+
+	/**
+	 * The peers and the units of the cells, shared by all the engines of this shape.
+	 */
+	const Geometry *geometry;
+
+	/**
+	 * The cells that have been assigned but not propagated yet.
+	 */
+	unsigned int *queue;
+	unsigned int queueLen;
+
+	/**
+	 * The trail of the changes.
+	 */
+	CPTrailEntry *trail;
+	unsigned int trailLen;
+
+	/**
+	 * The branching points of the search.
+	 */
+	CPFrame *frames;
+
+	/**
+	 * If it is not 0, the search tries the values of a cell in a random order, drawn from
+	 * [rng], so it finds a random solution. Otherwise it tries them in increasing order.
+	 */
+	Rng *rng;
+
+	/**
+	 * The search gives up after [nodesLimit] branching decisions, 0 for no limit.
+	 */
+	unsigned long nodesLimit;
+
+	/**
+	 * The statistics of the last search.
+	 */
+	CPStats stats;
+} CPEngine;
+
+/**
+ * This method creates a new engine for boards of n*m blocks.
+ *
+ * Parameters:
+ * unsigned int n - The number of rows in each block
+ * unsigned int m - The number of columns in each block
+ *
+ * Preconditions:
+ * n,m ≥ 1
+ *
+ * Returns:
+ * A pointer to a new dynamically allocated engine
+ */
+CPEngine *createCPEngine(unsigned int n, unsigned int m);
+
+/**
+ * This method destroys an engine.
+ *
+ * Preconditions:
+ * engine != 0
+ */
+void destroyCPEngine(CPEngine *engine);
+
+/**
+ * This method loads the values of a puzzle into an engine, and propagates them.
+ *
+ * Parameters:
+ * CPEngine *engine
+ * Puzzle *p
+ *
+ * Preconditions:
+ * engine, p != 0
+ * p->n == engine->n ∧ p->m == engine->m
+ *
+ * Returns:
+ * FALSE iff a contradiction has been found, i.e. [p] is unsolvable
+ */
+Bool loadCPEngine(CPEngine *engine, Puzzle *p);
+
+/**
+ * This method removes a value from the candidates of a cell of the loaded board,
+ * and propagates the removal.
+ *
+ * Parameters:
+ * CPEngine *engine
+ * unsigned int c - The index of the cell
+ * unsigned int v - The value
+ *
+ * Preconditions:
+ * engine != 0
+ * The last loadCPEngine(engine, ...) has returned TRUE
+ * c < engine->cellsNum, 1 ≤ v ≤ engine->dim
+ *
+ * Returns:
+ * FALSE iff a contradiction has been found, i.e. the board has no solution in which
+ * the cell c does not contain v
+ */
+Bool excludeCPValue(CPEngine *engine, unsigned int c, unsigned int v);
+
+/**
+ * This method searches for a solution of the loaded board.
+ * The statistics of the search are stored in engine->stats.
+ *
+ * Parameters:
+ * CPEngine *engine
+ *
+ * Preconditions:
+ * engine != 0
+ * The last loadCPEngine(engine, ...) has returned TRUE
+ *
+ * Returns:
+ * TRUE iff a solution has been found. In this case engine->value contains it.
+ * FALSE is returned also when engine->nodesLimit is reached, i.e.
+ * engine->stats.nodes == engine->nodesLimit.
+ */
+Bool searchCPEngine(CPEngine *engine);
+
+/**
+  * This method solves p using constraint propagation and backtracking.
+  *
+  * Parameters:
+  * Puzzle *p
+  * CPStats *stats - The statistics of the search would be stored here, may be 0
+  *
+  * Preconditions:
+  * p != 0
+  *
+  * Returns:
+  * TRUE iff [p] is solvable
+  *
+  * Postconditions:
+  * [p] is filled with values iff TRUE is returned
+  */
+Bool CPSolver(Puzzle *p, CPStats *stats);
+
+#endif
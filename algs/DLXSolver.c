@@ -0,0 +1,331 @@
+#include "DLXSolver.h"
+#include <assert.h>
+#include "../utils/MemAlloc.h"
+
+/**
+ * This struct represents a node of the dancing links matrix.
+ * The links are indices in the nodes array.
+ */
+typedef struct {
+	unsigned int left;
+	unsigned int right;
+	unsigned int up;
+	unsigned int down;
+
+	/**
+	 * The column header of the node.
+	 */
+	unsigned int col;
+} DLXNode;
+
+/**
+ * This struct represents the exact cover matrix of a puzzle.
+ * There are 4 * dim^2 columns (constraints): the cell (x,y) has a value,
+ * the row x contains v, the column y contains v and the block b contains v.
+ * There is a row (with 4 nodes) for every candidate (cell, value): a single row
+ * for a non-empty cell and dim rows for an empty cell.
+ */
+typedef struct {
+
+	/**
+	 * n*m
+	 */
+	unsigned int dim;
+
+	/**
+	 * The number of the columns.
+	 */
+	unsigned int colsNum;
+
+	/**
+	 * The nodes of the matrix: nodes[0] is the root, nodes[1..colsNum] are the column
+	 * headers, and every row occupies 4 consecutive nodes after them.
+	 */
+	DLXNode *nodes;
+
+	/**
+	 * The number of the nodes that are currently linked in each column.
+	 */
+	unsigned int *size;
+
+	/**
+	 * The candidate that each row represents, as (cell index) * dim + (value - 1).
+	 */
+	unsigned int *rowCand;
+
+	/**
+	 * The nodes of the rows that are chosen in each level of the search.
+	 */
+	unsigned int *choices;
+} DLX;
+
+/**
+ * This method appends a row to the matrix.
+ *
+ * Parameters:
+ * DLX *dlx
+ * unsigned int row - The index of the row
+ * unsigned int *cols - The 4 columns (1-based) of the row
+ */
+static void appendRow(DLX *dlx, unsigned int row, unsigned int *cols) {
+	unsigned int k, node, first = dlx->colsNum + 1 + 4 * row;
+	DLXNode *nodes = dlx->nodes;
+
+	for (k = 0; k < 4; k++) {
+		node = first + k;
+		nodes[node].col = cols[k];
+		nodes[node].down = cols[k];
+		nodes[node].up = nodes[cols[k]].up;
+		nodes[nodes[cols[k]].up].down = node;
+		nodes[cols[k]].up = node;
+		nodes[node].left = first + (k + 3) % 4;
+		nodes[node].right = first + (k + 1) % 4;
+		dlx->size[cols[k]]++;
+	}
+}
+
+/**
+ * This method creates the exact cover matrix of a puzzle.
+ *
+ * Preconditions:
+ * p != 0
+ */
+static DLX *createDLX(Puzzle *p) {
+	unsigned int dim = p->n * p->m, dim2 = dim * dim;
+	unsigned int x, y, v, first, last, rowsNum = 0, row = 0, c;
+	unsigned int cols[4];
+	DLX *memAlloc(dlx, DLX);
+
+	for (x = 0; x < dim; x++) {
+		for (y = 0; y < dim; y++) {
+			rowsNum += getBoardValue(p, x, y) ? 1 : dim;
+		}
+	}
+
+	dlx->dim = dim;
+	dlx->colsNum = 4 * dim2;
+	memAllocN(dlx->nodes, DLXNode, dlx->colsNum + 1 + 4 * rowsNum);
+	memAllocN(dlx->size, unsigned int, dlx->colsNum + 1);
+	memAllocN(dlx->rowCand, unsigned int, rowsNum);
+	memAllocN(dlx->choices, unsigned int, dim2);
+
+	for (c = 0; c <= dlx->colsNum; c++) { /* the root and the column headers */
+		dlx->nodes[c].left = c == 0 ? dlx->colsNum : c - 1;
+		dlx->nodes[c].right = c == dlx->colsNum ? 0 : c + 1;
+		dlx->nodes[c].up = c;
+		dlx->nodes[c].down = c;
+		dlx->nodes[c].col = c;
+	}
+
+	for (x = 0; x < dim; x++) {
+		for (y = 0; y < dim; y++) {
+			v = getBoardValue(p, x, y);
+			first = v ? v - 1 : 0;
+			last = v ? v - 1 : dim - 1;
+			for (v = first; v <= last; v++) {
+				cols[0] = 1 + x * dim + y;
+				cols[1] = 1 + dim2 + x * dim + v;
+				cols[2] = 1 + 2 * dim2 + y * dim + v;
+				cols[3] = 1 + 3 * dim2 + getBlockIndex(p, x, y) * dim + v;
+				dlx->rowCand[row] = (x * dim + y) * dim + v;
+				appendRow(dlx, row++, cols);
+			}
+		}
+	}
+
+	return dlx;
+}
+
+/**
+ * This method destroys an exact cover matrix.
+ *
+ * Preconditions:
+ * dlx != 0
+ */
+static void destroyDLX(DLX *dlx) {
+	memFree(dlx->nodes);
+	memFree(dlx->size);
+	memFree(dlx->rowCand);
+	memFree(dlx->choices);
+	memFree(dlx);
+}
+
+/**
+ * This method removes the column c from the header list, and removes all the rows
+ * that intersect c from the other columns.
+ */
+static void cover(DLX *dlx, unsigned int c) {
+	DLXNode *nodes = dlx->nodes;
+	unsigned int i, j;
+
+	nodes[nodes[c].right].left = nodes[c].left;
+	nodes[nodes[c].left].right = nodes[c].right;
+	for (i = nodes[c].down; i != c; i = nodes[i].down) {
+		for (j = nodes[i].right; j != i; j = nodes[j].right) {
+			nodes[nodes[j].down].up = nodes[j].up;
+			nodes[nodes[j].up].down = nodes[j].down;
+			dlx->size[nodes[j].col]--;
+		}
+	}
+}
+
+/**
+ * This method reverts cover(dlx, c).
+ */
+static void uncover(DLX *dlx, unsigned int c) {
+	DLXNode *nodes = dlx->nodes;
+	unsigned int i, j;
+
+	for (i = nodes[c].up; i != c; i = nodes[i].up) {
+		for (j = nodes[i].left; j != i; j = nodes[j].left) {
+			dlx->size[nodes[j].col]++;
+			nodes[nodes[j].down].up = j;
+			nodes[nodes[j].up].down = j;
+		}
+	}
+	nodes[nodes[c].right].left = c;
+	nodes[nodes[c].left].right = c;
+}
+
+/**
+ * This method covers the columns of the row of the node r, except the column of r itself.
+ */
+static void selectRow(DLX *dlx, unsigned int r) {
+	unsigned int j;
+	for (j = dlx->nodes[r].right; j != r; j = dlx->nodes[j].right) {
+		cover(dlx, dlx->nodes[j].col);
+	}
+}
+
+/**
+ * This method reverts selectRow(dlx, r).
+ */
+static void unselectRow(DLX *dlx, unsigned int r) {
+	unsigned int j;
+	for (j = dlx->nodes[r].left; j != r; j = dlx->nodes[j].left) {
+		uncover(dlx, dlx->nodes[j].col);
+	}
+}
+
+/**
+ * This method returns the uncovered column with the minimal number of nodes.
+ *
+ * Preconditions:
+ * There is an uncovered column
+ */
+static unsigned int chooseColumn(DLX *dlx) {
+	unsigned int c, best = dlx->nodes[0].right;
+	for (c = best; c != 0 && dlx->size[best] > 1; c = dlx->nodes[c].right) {
+		if (dlx->size[c] < dlx->size[best]) {
+			best = c;
+		}
+	}
+	return best;
+}
+
+/**
+ * This method replaces the deepest choice of the search by the next row in its column.
+ * If the column is exhausted, the search backtracks to the previous level.
+ *
+ * Parameters:
+ * DLX *dlx
+ * unsigned int *level - The current level of the search
+ *
+ * Returns:
+ * FALSE iff the search space is exhausted
+ */
+static Bool nextChoice(DLX *dlx, unsigned int *level) {
+	unsigned int r, c;
+	while (*level > 0) {
+		r = dlx->choices[*level - 1];
+		c = dlx->nodes[r].col;
+		unselectRow(dlx, r);
+		r = dlx->nodes[r].down;
+		if (r != c) {
+			dlx->choices[*level - 1] = r;
+			selectRow(dlx, r);
+			return TRUE;
+		}
+		uncover(dlx, c);
+		(*level)--;
+	}
+	return FALSE;
+}
+
+/**
+ * This method searches for exact covers of the matrix.
+ *
+ * Parameters:
+ * DLX *dlx
+ * unsigned long limit - The search stops after [limit] covers have been found
+ * unsigned int *solution - The values of the cells (row by row) in the first cover would be stored here, may be 0
+ *
+ * Preconditions:
+ * limit ≥ 1
+ * [solution] is an array of size dim^2
+ *
+ * Returns:
+ * The number of covers that have been found (at most [limit])
+ */
+static unsigned long searchDLX(DLX *dlx, unsigned long limit, unsigned int *solution) {
+	unsigned int level = 0, c, i, cand;
+	unsigned long count = 0;
+	Bool advanced;
+
+	while (TRUE) {
+		advanced = FALSE;
+		if (dlx->nodes[0].right == 0) { /* every column is covered */
+			if (count++ == 0 && solution) {
+				for (i = 0; i < level; i++) {
+					cand = dlx->rowCand[(dlx->choices[i] - dlx->colsNum - 1) / 4];
+					solution[cand / dlx->dim] = cand % dlx->dim + 1;
+				}
+			}
+			if (count == limit) {
+				break;
+			}
+		} else {
+			c = chooseColumn(dlx);
+			if (dlx->size[c] > 0) {
+				cover(dlx, c);
+				dlx->choices[level++] = dlx->nodes[c].down;
+				selectRow(dlx, dlx->nodes[c].down);
+				advanced = TRUE;
+			}
+		}
+
+		if (!advanced && !nextChoice(dlx, &level)) {
+			break;
+		}
+	}
+
+	return count;
+}
+
+Bool DLXSolver(Puzzle *p) {
+	unsigned int dim = p->n * p->m, i;
+	Bool ret;
+	DLX *dlx = createDLX(p);
+	unsigned int *memAllocN(solution, unsigned int, dim * dim);
+
+	ret = searchDLX(dlx, 1, solution) == 1;
+	if (ret) {
+		for (i = 0; i < dim * dim; i++) {
+			setBoardValue(p, i / dim, i % dim, solution[i]);
+		}
+	}
+
+	destroyDLX(dlx);
+	memFree(solution);
+	return ret;
+}
+
+unsigned long DLXCountSolutions(Puzzle *p, unsigned long limit) {
+	unsigned long ret;
+	DLX *dlx = createDLX(p);
+
+	ret = searchDLX(dlx, limit, 0);
+
+	destroyDLX(dlx);
+	return ret;
+}
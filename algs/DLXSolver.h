@@ -0,0 +1,48 @@
+#ifndef __ALGS_DLXSOLVER_H
+#define __ALGS_DLXSOLVER_H
+/**
+ * This module comprises an exact cover based sudoku solver and solution counter. The counter
+ * counts the solutions of the boards that are too wide for the backtracking counter (see
+ * exhBacktr), and the solver is timed against the other solvers by solver-bench.
+ * The board is translated into an exact cover problem (every cell has a value,
+ * every value appears once in every row, column and block), which is solved
+ * by Knuth's Algorithm X using dancing links.
+ * It does not depend on any external library.
+ */
+
+#include "../dataStructures/Puzzle.h"
+
+/**
+  * This method solves p using dancing links.
+  *
+  * Parameters:
+  * Puzzle *p
+  *
+  * Preconditions:
+  * p != 0
+  *
+  * Returns:
+  * TRUE iff [p] is solvable
+  *
+  * Postconditions:
+  * [p] is filled with values iff TRUE is returned
+  */
+Bool DLXSolver(Puzzle *p);
+
+/**
+  * This method counts the solutions of p using dancing links.
+  *
+  * Parameters:
+  * Puzzle *p
+  * unsigned long limit - The counting stops after [limit] solutions have been found
+  *
+  * Preconditions:
+  * p != 0
+  * limit ≥ 1
+  *
+  * Returns:
+  * The number of the solutions of [p], or [limit] if there are at least [limit] solutions
+  */
+unsigned long DLXCountSolutions(Puzzle *p, unsigned long limit);
+
+#endif
@@ -0,0 +1,209 @@
+#include "GridBank.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GridValidator.h"
+#include "../IO.h"
+#include "../utils/MemAlloc.h"
+
+/**
+ * The maximal length of the path of a bank file.
+ */
+#define maxBankPathLength 64
+
+/**
+ * The bank that has been read last, 0 if none.
+ */
+static GridBank *lastBank = 0;
+
+/**
+ * The dimensions of the blocks of the last bank that could not be read, 0 if none.
+ * Hence a missing bank file is looked up once, and not on every generated puzzle.
+ */
+static unsigned int missingN = 0, missingM = 0;
+
+/**
+ * This method fills [perm] with a random permutation of the dim lines (rows or columns)
+ * of a board, that keeps every group of [groupLen] consecutive lines together.
+ */
+static void shuffleLines(unsigned int *perm, unsigned int dim, unsigned int groupLen,
+		unsigned int *scratch, Rng *rng) {
+	unsigned int g, k, groupsNum = dim / groupLen;
+	unsigned int *groups = scratch, *lines = scratch + groupsNum;
+
+	for (g = 0; g < groupsNum; g++) {
+		groups[g] = g;
+	}
+	for (k = 0; k < groupLen; k++) {
+		lines[k] = k;
+	}
+	rngShuffle(rng, groups, groupsNum);
+	for (g = 0; g < groupsNum; g++) {
+		rngShuffle(rng, lines, groupLen);
+		for (k = 0; k < groupLen; k++) {
+			perm[g * groupLen + k] = groups[g] * groupLen + lines[k];
+		}
+	}
+}
+
+static void destroyGridBank(GridBank *bank) {
+	memFree(bank->grids);
+	memFree(bank);
+}
+
+/**
+ * This method drops the grids of a bank that are not solved grids, i.e. grids with an
+ * empty cell or with a value that appears twice in a row, a column or a block.
+ */
+static void dropUnsolvedGrids(GridBank *bank) {
+	unsigned int g, c, kept = 0, cellsNum = bank->n * bank->m * bank->n * bank->m;
+	Bool *legal;
+
+	memAllocN(legal, Bool, bank->gridsNum);
+	validateGrids(bank->n, bank->m, bank->grids, bank->gridsNum, legal);
+	for (g = 0; g < bank->gridsNum; g++) {
+		for (c = 0; c < cellsNum && legal[g]; c++) {
+			legal[g] = bank->grids[g * cellsNum + c] != 0;
+		}
+		if (legal[g]) {
+			memmove(bank->grids + kept * cellsNum, bank->grids + g * cellsNum, cellsNum * sizeof(unsigned int));
+			kept++;
+		}
+	}
+	bank->gridsNum = kept;
+	memFree(legal);
+}
+
+/**
+ * This method reads the bank file of the grids of n*m blocks, and keeps only its solved grids.
+ *
+ * Returns:
+ * The bank, or 0 if the file cannot be read or does not contain any solved grid
+ */
+static GridBank *readGridBank(unsigned int n, unsigned int m) {
+	char path[maxBankPathLength];
+	unsigned int fn, fm, dim = n * m, capacity = 16;
+	unsigned int *grids;
+	GridBank *bank;
+	FILE *fp;
+
+	sprintf(path, gridBankPathFormat, n, m);
+	fp = fopen(path, "r");
+	if (!fp) {
+		return 0;
+	}
+	if (fscanf(fp, "%u %u", &fn, &fm) != 2 || fn != n || fm != m) {
+		fclose(fp);
+		return 0;
+	}
+
+	memAlloc(bank, GridBank);
+	bank->n = n;
+	bank->m = m;
+	bank->gridsNum = 0;
+	memAllocN(bank->grids, unsigned int, capacity * dim * dim);
+	while (readCompactBoard(fp, dim, bank->grids + bank->gridsNum * dim * dim)) {
+		if (++bank->gridsNum == capacity) {
+			capacity *= 2;
+			grids = realloc(bank->grids, capacity * dim * dim * sizeof(unsigned int));
+			if (!grids) {
+				fatalError("realloc");
+			}
+			bank->grids = grids;
+		}
+	}
+	fclose(fp);
+
+	if (bank->gridsNum) {
+		dropUnsolvedGrids(bank);
+	}
+	if (!bank->gridsNum) {
+		destroyGridBank(bank);
+		return 0;
+	}
+	return bank;
+}
+
+GridBank *getGridBank(unsigned int n, unsigned int m) {
+	if (missingN == n && missingM == m) {
+		return 0;
+	}
+	if (lastBank && (lastBank->n != n || lastBank->m != m)) {
+		freeGridBanks();
+	}
+	if (!lastBank) {
+		lastBank = readGridBank(n, m);
+		missingN = lastBank ? 0 : n;
+		missingM = lastBank ? 0 : m;
+	}
+	return lastBank;
+}
+
+void freeGridBanks() {
+	if (lastBank) {
+		destroyGridBank(lastBank);
+		lastBank = 0;
+	}
+	missingN = missingM = 0;
+}
+
+Bool writeGridBank(unsigned int n, unsigned int m, const unsigned int *grids, unsigned int gridsNum) {
+	char path[maxBankPathLength];
+	unsigned int g, dim = n * m;
+	Bool written;
+	FILE *fp;
+
+	if ((lastBank && lastBank->n == n && lastBank->m == m) || (missingN == n && missingM == m)) {
+		freeGridBanks();
+	}
+
+	sprintf(path, gridBankPathFormat, n, m);
+	fp = fopen(path, "w");
+	if (!fp) {
+		return FALSE;
+	}
+
+	written = fprintf(fp, "%u %u\n", n, m) > 0;
+	for (g = 0; g < gridsNum && written; g++) {
+		written = writeCompactBoard(fp, dim, grids + g * dim * dim);
+	}
+
+	return !fclose(fp) && written;
+}
+
+void fillPatternGrid(unsigned int n, unsigned int m, unsigned int *values) {
+	unsigned int x, y, dim = n * m;
+
+	for (x = 0; x < dim; x++) {
+		for (y = 0; y < dim; y++) {
+			values[x * dim + y] = (m * (x % n) + x / n + y) % dim + 1;
+		}
+	}
+}
+
+void transformGrid(unsigned int n, unsigned int m, unsigned int *values, unsigned int *scratch, Rng *rng) {
+	unsigned int x, y, v, dim = n * m;
+	unsigned int *source = scratch, *labels = source + dim * dim, *rows = labels + dim + 1, *cols = rows + dim;
+	Bool transpose = n == m && rngBelow(rng, 2);
+
+	for (v = 0; v <= dim; v++) {
+		labels[v] = v;
+	}
+	rngShuffle(rng, labels + 1, dim);
+	shuffleLines(rows, dim, n, cols + dim, rng); /* a band consists of n rows */
+	shuffleLines(cols, dim, m, cols + dim, rng); /* a stack consists of m columns */
+
+	memcpy(source, values, dim * dim * sizeof(unsigned int));
+	for (x = 0; x < dim; x++) {
+		for (y = 0; y < dim; y++) {
+			v = labels[source[rows[x] * dim + cols[y]]];
+			if (transpose) {
+				values[y * dim + x] = v;
+			} else {
+				values[x * dim + y] = v;
+			}
+		}
+	}
+}
+
+#undef maxBankPathLength
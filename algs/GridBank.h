@@ -0,0 +1,109 @@
+#ifndef __ALGS_GRIDBANK_H
+#define __ALGS_GRIDBANK_H
+/**
+ * This module derives solved grids from each other. Every solved grid of n*m blocks
+ * stays solved under the relabelling of the values, the permutations of the rows within
+ * a band (n rows) and of the bands, the permutations of the columns within a stack
+ * (m columns) and of the stacks, and the transposition if n == m.
+ * The base grids are taken from a bank file of solved grids per (n, m), or are
+ * constructed by a pattern for any n*m.
+ */
+
+#include "../utils/Boolean.h"
+#include "../utils/Rng.h"
+
+/**
+ * The path of the bank file of the grids of n*m blocks, formatted with n and m.
+ * The file starts with a line "n m", followed by a grid per line in the compact
+ * format of writeCompactBoard.
+ */
+#define gridBankPathFormat "grids_%ux%u.bank"
+
+/**
+ * The length of the scratch memory of transformGrid for n*m blocks: the source grid (n*m)^2,
+ * the labels n*m + 1, the permutations of the rows and of the columns 2 * n*m, and the
+ * groups and the lines of a single permutation n + m.
+ */
+#define transformScratchLen(n, m) ((n) * (m) * ((n) * (m) + 3) + (n) + (m) + 1)
+
+/**
+ * This struct defines a bank of solved grids.
+ */
+typedef struct {
+	unsigned int n;
+	unsigned int m;
+
+	/**
+	 * The values of the grid g are grids[g * (n*m)^2], ..., grids[(g + 1) * (n*m)^2 - 1], row by row.
+	 */
+	unsigned int *grids;
+	unsigned int gridsNum;
+} GridBank;
+
+/**
+ * This method returns the bank of the grids of n*m blocks. The bank is read from its file
+ * once, and is kept until freeGridBanks is called or the bank is rewritten; the grids of
+ * the file that are not solved grids are dropped. A missing bank is remembered as well.
+ * It is not thread-safe, but the returned bank may be read by several threads.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ *
+ * Returns:
+ * The bank, or 0 if the file does not exist or does not contain any solved grid.
+ */
+GridBank *getGridBank(unsigned int n, unsigned int m);
+
+/**
+ * This method frees the banks that have been read by getGridBank, and forgets the missing ones.
+ */
+void freeGridBanks();
+
+/**
+ * This method writes a bank file, and drops the bank of n*m blocks that has been read before.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * const unsigned int *grids - The grids, as in GridBank
+ * unsigned int gridsNum
+ *
+ * Preconditions:
+ * grids != 0
+ * Every grid is a solved grid
+ *
+ * Returns:
+ * TRUE iff the operation succeeded.
+ */
+Bool writeGridBank(unsigned int n, unsigned int m, const unsigned int *grids, unsigned int gridsNum);
+
+/**
+ * This method constructs a solved grid by a pattern: the cell (x,y) contains
+ * (m * (x % n) + x / n + y) % (n*m) + 1.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * unsigned int *values - The values of the cells would be stored here, row by row
+ *
+ * Preconditions:
+ * [values] is an array of size (n*m)^2
+ */
+void fillPatternGrid(unsigned int n, unsigned int m, unsigned int *values);
+
+/**
+ * This method applies a random validity-preserving transform to a solved grid (see the
+ * description of this module).
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * unsigned int *values - The values of the cells, row by row
+ * unsigned int *scratch - Scratch memory of transformScratchLen(n, m) values, so the
+ *		transform does not allocate memory
+ * Rng *rng - The generator of the random choices
+ *
+ * Preconditions:
+ * rng != 0
+ * [values] is an array of size (n*m)^2
+ */
+void transformGrid(unsigned int n, unsigned int m, unsigned int *values, unsigned int *scratch, Rng *rng);
+
+#endif
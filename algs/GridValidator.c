@@ -0,0 +1,302 @@
+#include "GridValidator.h"
+#include <assert.h>
+#include "../dataStructures/Geometry.h"
+#include "../utils/Bitset.h"
+#include "../utils/MemAlloc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD)
+#define SIMD_VALIDATOR
+#include <immintrin.h>
+#endif
+
+/**
+ * This method fills stacks[y] with the index of the stack (the block column) of the column y.
+ * The block of the cell (x,y) is x / n * n + stacks[y].
+ */
+static void fillStacks(unsigned int n, unsigned int m, unsigned int *stacks) {
+	unsigned int y;
+
+	for (y = 0; y < n * m; y++) {
+		stacks[y] = y / m;
+	}
+}
+
+/**
+ * This method validates a single grid.
+ *
+ * Returns:
+ * TRUE iff the grid is legal
+ */
+static Bool isGridLegalScalar(unsigned int n, unsigned int m, const unsigned int *stacks,
+		const unsigned int *values) {
+	unsigned int x, y, v, b, band, dim = n * m;
+	ValueMask row, bit, dup = 0, cols[maxMaskDim], blocks[maxMaskDim];
+	Bool inRange = TRUE;
+
+	for (b = 0; b < dim; b++) {
+		cols[b] = 0;
+		blocks[b] = 0;
+	}
+
+	for (x = 0; x < dim; x++) {
+		row = 0;
+		band = x / n * n;
+		for (y = 0; y < dim; y++) { /* branch free: the empty cells are unpredictable */
+			v = *values++;
+			inRange &= v <= dim;
+			bit = (ValueMask) (v - 1 < dim) << ((v - 1) % maxMaskDim); /* no bit for v == 0 */
+			b = band + stacks[y];
+			dup |= (row | cols[y] | blocks[b]) & bit;
+			row |= bit;
+			cols[y] |= bit;
+			blocks[b] |= bit;
+		}
+		if (dup) { /* the first row with a duplicate decides */
+			return FALSE;
+		}
+	}
+
+	return inRange;
+}
+
+/**
+ * This method validates a single grid whose values do not fit in a ValueMask, like
+ * isGridLegalScalar: the masks of the units are bitsets of bitsetWords(n*m) words.
+ *
+ * Parameters:
+ * const Geometry *geometry - The geometry of the grid
+ * ValueMask *seen - Scratch memory of (2 * n*m + 1) * bitsetWords(n*m) words
+ * const unsigned int *values
+ *
+ * Returns:
+ * TRUE iff the grid is legal
+ */
+static Bool isGridLegalWords(const Geometry *geometry, ValueMask *seen, const unsigned int *values) {
+	unsigned int x, y, v, w, dim = geometry->dim, words = bitsetWords(dim);
+	ValueMask bit, dup = 0, *row = seen, *cols = seen + words, *blocks = cols + dim * words, *col, *block;
+	Bool inRange = TRUE;
+
+	clearBitset(cols, 2 * dim * words);
+	for (x = 0; x < dim; x++) {
+		clearBitset(row, words);
+		for (y = 0; y < dim; y++) {
+			v = *values++;
+			inRange &= v <= dim;
+			w = (v - 1) % dim / maxMaskDim; /* the word of v, any word if v is out of range */
+			bit = (ValueMask) (v - 1 < dim) << ((v - 1) % maxMaskDim);
+			col = cols + y * words + w;
+			block = blocks + geometry->block[x * dim + y] * words + w;
+			dup |= (row[w] | *col | *block) & bit;
+			row[w] |= bit;
+			*col |= bit;
+			*block |= bit;
+		}
+		if (dup) {
+			return FALSE;
+		}
+	}
+
+	return inRange;
+}
+
+#ifdef SIMD_VALIDATOR
+
+/**
+ * This method validates 4 grids, a grid per 32-bit lane.
+ * The bit of a value v is computed as the float 2^(v-1), whose exponent field is v + 126,
+ * converted to an integer: v == 0 yields 0.5, i.e. no bit, and v == 32 overflows to the
+ * "integer indefinite" 0x80000000, which is the right bit as well.
+ *
+ * Parameters:
+ * const unsigned int *grids - The first of 4 consecutive grids
+ *
+ * Returns:
+ * A mask whose bit k is on iff the grid k is legal
+ */
+__attribute__((target("sse2")))
+static unsigned int validateLanesSSE2(unsigned int n, unsigned int m, const unsigned int *stacks,
+		const unsigned int *grids) {
+	unsigned int x, y, b, band, dim = n * m, cellsNum = dim * dim;
+	const unsigned int *cell = grids;
+	__m128i cols[maxSimdValidatorDim], blocks[maxSimdValidatorDim];
+	__m128i v, bit, row, dup = _mm_setzero_si128(), inRange = _mm_set1_epi32(-1);
+	__m128i sign = _mm_set1_epi32((int) 0x80000000U), maxValue = _mm_set1_epi32((int) (dim ^ 0x80000000U));
+	__m128i exponentBias = _mm_set1_epi32(126);
+
+	for (b = 0; b < dim; b++) {
+		cols[b] = _mm_setzero_si128();
+		blocks[b] = _mm_setzero_si128();
+	}
+
+	for (x = 0; x < dim; x++) {
+		row = _mm_setzero_si128();
+		band = x / n * n;
+		for (y = 0; y < dim; y++, cell++) {
+			v = _mm_setr_epi32((int) cell[0], (int) cell[cellsNum], (int) cell[2 * cellsNum],
+					(int) cell[3 * cellsNum]);
+			/* v ≤ dim as unsigned integers, by a signed comparison of the flipped values */
+			inRange = _mm_andnot_si128(_mm_cmpgt_epi32(_mm_xor_si128(v, sign), maxValue), inRange);
+			bit = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(v, exponentBias), 23)));
+			b = band + stacks[y];
+			dup = _mm_or_si128(dup, _mm_and_si128(bit, _mm_or_si128(row, _mm_or_si128(cols[y], blocks[b]))));
+			row = _mm_or_si128(row, bit);
+			cols[y] = _mm_or_si128(cols[y], bit);
+			blocks[b] = _mm_or_si128(blocks[b], bit);
+		}
+	}
+
+	return (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(
+			_mm_and_si128(inRange, _mm_cmpeq_epi32(dup, _mm_setzero_si128()))));
+}
+
+/**
+ * This method validates 8 grids, a grid per 32-bit lane, see validateLanesSSE2.
+ * The cells are gathered from the 8 grids, and the bit of a value v is 1 << (v - 1) by a
+ * variable shift, which yields 0 for v == 0 (a shift by 2^32 - 1).
+ */
+__attribute__((target("avx2")))
+static unsigned int validateLanesAVX2(unsigned int n, unsigned int m, const unsigned int *stacks,
+		const unsigned int *grids) {
+	unsigned int x, y, b, band, dim = n * m, cellsNum = dim * dim;
+	const unsigned int *cell = grids;
+	__m256i cols[maxSimdValidatorDim], blocks[maxSimdValidatorDim];
+	__m256i v, bit, row, dup = _mm256_setzero_si256(), inRange = _mm256_set1_epi32(-1);
+	__m256i one = _mm256_set1_epi32(1), maxValue = _mm256_set1_epi32((int) dim);
+	__m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+			_mm256_set1_epi32((int) cellsNum));
+
+	for (b = 0; b < dim; b++) {
+		cols[b] = _mm256_setzero_si256();
+		blocks[b] = _mm256_setzero_si256();
+	}
+
+	for (x = 0; x < dim; x++) {
+		row = _mm256_setzero_si256();
+		band = x / n * n;
+		for (y = 0; y < dim; y++, cell++) {
+			v = _mm256_i32gather_epi32((const int *) cell, offsets, 4);
+			inRange = _mm256_and_si256(inRange, _mm256_cmpeq_epi32(_mm256_max_epu32(v, maxValue), maxValue));
+			bit = _mm256_sllv_epi32(one, _mm256_sub_epi32(v, one));
+			b = band + stacks[y];
+			dup = _mm256_or_si256(dup,
+					_mm256_and_si256(bit, _mm256_or_si256(row, _mm256_or_si256(cols[y], blocks[b]))));
+			row = _mm256_or_si256(row, bit);
+			cols[y] = _mm256_or_si256(cols[y], bit);
+			blocks[b] = _mm256_or_si256(blocks[b], bit);
+		}
+	}
+
+	return (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_and_si256(inRange, _mm256_cmpeq_epi32(dup, _mm256_setzero_si256()))));
+}
+
+/**
+ * This method validates the grids of a batch in groups of lanes by a SIMD kernel,
+ * and leaves the remaining grids (fewer than a group) to the scalar kernel.
+ *
+ * Returns:
+ * The number of the grids that have been validated
+ */
+static unsigned long validateLanes(ValidatorKernel kernel, unsigned int n, unsigned int m,
+		const unsigned int *stacks, const unsigned int *grids, unsigned long gridsNum, Bool *legal,
+		unsigned long *count) {
+	unsigned int k, lanesMask, cellsNum = n * m * n * m;
+	unsigned int lanes = kernel == validatorAVX2 ? 8 : kernel == validatorSSE2 ? 4 : 0;
+	unsigned long g = 0;
+	Bool isLegal;
+
+	for (; lanes && g + lanes <= gridsNum; g += lanes) {
+		if (kernel == validatorAVX2) {
+			lanesMask = validateLanesAVX2(n, m, stacks, grids + g * cellsNum);
+		} else {
+			lanesMask = validateLanesSSE2(n, m, stacks, grids + g * cellsNum);
+		}
+		for (k = 0; k < lanes; k++) {
+			isLegal = (lanesMask >> k) & 1;
+			*count += isLegal;
+			if (legal) {
+				legal[g + k] = isLegal;
+			}
+		}
+	}
+
+	return g;
+}
+
+#endif
+
+Bool isValidatorKernelSupported(ValidatorKernel kernel) {
+	switch (kernel) {
+	case validatorScalar:
+		return TRUE;
+#ifdef SIMD_VALIDATOR
+	case validatorSSE2:
+		return __builtin_cpu_supports("sse2") != 0;
+	case validatorAVX2:
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	default:
+		return FALSE;
+	}
+}
+
+ValidatorKernel bestValidatorKernel(unsigned int dim) {
+	if (dim <= maxSimdValidatorDim) {
+		if (isValidatorKernelSupported(validatorAVX2)) {
+			return validatorAVX2;
+		}
+		if (isValidatorKernelSupported(validatorSSE2)) {
+			return validatorSSE2;
+		}
+	}
+	return validatorScalar;
+}
+
+unsigned long validateGridsWith(ValidatorKernel kernel, unsigned int n, unsigned int m,
+		const unsigned int *grids, unsigned long gridsNum, Bool *legal) {
+	unsigned int dim = n * m, cellsNum = dim * dim, stacks[maxMaskDim];
+	unsigned long g = 0, count = 0;
+	const Geometry *geometry = 0;
+	ValueMask *seen = 0;
+	Bool isLegal;
+
+	assert(isValidatorKernelSupported(kernel));
+	assert(kernel == validatorScalar || dim <= maxSimdValidatorDim);
+	if (dim > maxMaskDim) {
+		geometry = getGeometry(n, m);
+		memAllocN(seen, ValueMask, (2 * dim + 1) * bitsetWords(dim));
+	} else {
+		fillStacks(n, m, stacks);
+	}
+
+#ifdef SIMD_VALIDATOR
+	g = validateLanes(kernel, n, m, stacks, grids, gridsNum, legal, &count);
+#else
+	if (kernel) { /* only the scalar kernel is built */
+	}
+#endif
+
+	for (; g < gridsNum; g++) { /* the remaining grids */
+		if (seen) {
+			isLegal = isGridLegalWords(geometry, seen, grids + g * cellsNum);
+		} else {
+			isLegal = isGridLegalScalar(n, m, stacks, grids + g * cellsNum);
+		}
+		count += isLegal;
+		if (legal) {
+			legal[g] = isLegal;
+		}
+	}
+
+	if (seen) {
+		memFree(seen);
+	}
+	return count;
+}
+
+unsigned long validateGrids(unsigned int n, unsigned int m, const unsigned int *grids,
+		unsigned long gridsNum, Bool *legal) {
+	return validateGridsWith(bestValidatorKernel(n * m), n, m, grids, gridsNum, legal);
+}
+
+#undef SIMD_VALIDATOR
@@ -0,0 +1,71 @@
+#ifndef __ALGS_GRIDVALIDATOR_H
+#define __ALGS_GRIDVALIDATOR_H
+/**
+ * This module validates many grids at once, e.g. a corpus of generated puzzles.
+ * A grid is legal iff all its values are in 0, ..., n*m and no non-zero value appears
+ * twice in a row, a column or a block.
+ * Every cell sets the bit of its value in the occupancy masks of its row, column and
+ * block, after checking it against them: dup |= seen[unit] & bit; seen[unit] |= bit.
+ * The SIMD kernels validate a grid per lane (4 grids with SSE2, 8 with AVX2), so all
+ * the units are checked by the same vertical operations and no lane ever waits for
+ * another. The kernel is chosen at runtime by the features of the processor, and the
+ * scalar kernel is used on other processors, for the remaining grids of a batch and for
+ * boards wider than maxSimdValidatorDim. Boards wider than maxMaskDim keep their masks
+ * in bitsets of several words (see Bitset).
+ * Building with NO_SIMD leaves only the scalar kernel.
+ */
+
+#include "../utils/Boolean.h"
+
+/**
+ * The maximal n*m that the SIMD kernels support: a mask is a 32-bit lane.
+ */
+#define maxSimdValidatorDim 32
+
+/**
+ * The validation kernels.
+ */
+typedef enum {
+	validatorScalar,
+	validatorSSE2,
+	validatorAVX2
+} ValidatorKernel;
+
+/**
+ * This method returns TRUE iff the kernel may run on this processor.
+ */
+Bool isValidatorKernelSupported(ValidatorKernel kernel);
+
+/**
+ * This method returns the fastest supported kernel for boards of dim*dim cells.
+ */
+ValidatorKernel bestValidatorKernel(unsigned int dim);
+
+/**
+ * This method validates grids by a certain kernel.
+ *
+ * Parameters:
+ * ValidatorKernel kernel
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * const unsigned int *grids - The values of the grid g are grids[g * (n*m)^2], ...,
+ *		grids[(g + 1) * (n*m)^2 - 1], row by row (as in GridBank)
+ * unsigned long gridsNum
+ * Bool *legal - legal[g] would be TRUE iff the grid g is legal, may be 0
+ *
+ * Preconditions:
+ * isValidatorKernelSupported(kernel)
+ * kernel == validatorScalar ∨ n*m ≤ maxSimdValidatorDim
+ *
+ * Returns:
+ * The number of the legal grids
+ */
+unsigned long validateGridsWith(ValidatorKernel kernel, unsigned int n, unsigned int m,
+		const unsigned int *grids, unsigned long gridsNum, Bool *legal);
+
+/**
+ * This method validates grids by the fastest supported kernel, see validateGridsWith.
+ */
+unsigned long validateGrids(unsigned int n, unsigned int m, const unsigned int *grids,
+		unsigned long gridsNum, Bool *legal);
+
+#endif
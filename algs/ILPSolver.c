@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include "gurobi_c.h"
 #include "../Strings.h"
+#include "../dataStructures/Geometry.h"
 #include "../utils/MemAlloc.h"
 
 Bool ILPSolver(Puzzle *p) {
@@ -10,13 +11,15 @@ Bool ILPSolver(Puzzle *p) {
 	unsigned int dim = p->n * p->m;
 	unsigned int dim2 = dim * dim;
 	unsigned int dim3 = dim2 * dim;
+	const Geometry *geometry = getGeometry(p->n, p->m);
+	const unsigned int *unit;
 	int *ind;
 	double *val;
 	double *lb;
 	char *vtype;
 	double *sol;
 	int optimstatus;
-	unsigned int i, j, v, ig, jg, count;
+	unsigned int i, j, v, u, k;
 	int error = 0;
 	Bool ret = FALSE;
 	memAllocN(ind, int, dim);
@@ -63,12 +66,13 @@ Bool ILPSolver(Puzzle *p) {
 		}
 	}
 
-	/* Each value must appear once in each row */
+	/* Each value must appear once in each row, column and subgrid */
 	for (v = 0; v < dim; v++) {
-		for (j = 0; j < dim; j++) {
-			for (i = 0; i < dim; i++) {
-				ind[i] = i * dim2 + j * dim + v;
-				val[i] = 1.0;
+		for (u = 0; u < 3 * dim; u++) {
+			unit = geometry->units + u * dim;
+			for (k = 0; k < dim; k++) {
+				ind[k] = unit[k] * dim + v;
+				val[k] = 1.0;
 			}
 
 			error = GRBaddconstr(model, dim, ind, val, GRB_EQUAL, 1.0, NULL);
@@ -76,37 +80,6 @@ Bool ILPSolver(Puzzle *p) {
 		}
 	}
 
-	/* Each value must appear once in each column */
-	for (v = 0; v < dim; v++) {
-		for (i = 0; i < dim; i++) {
-			for (j = 0; j < dim; j++) {
-				ind[j] = i * dim2 + j * dim + v;
-				val[j] = 1.0;
-			}
-
-			error = GRBaddconstr(model, dim, ind, val, GRB_EQUAL, 1.0, NULL);
-			if (error) goto ERROR;
-		}
-	}
-
-	/* Each value must appear once in each subgrid */
-	for (v = 0; v < dim; v++) {
-		for (ig = 0; ig < p->m; ig++) {
-			for (jg = 0; jg < p->n; jg++) {
-				count = 0;
-				for (i = ig * p->n; i < (ig + 1) * p->n; i++) {
-					for (j = jg * p->m; j < (jg + 1) * p->m; j++) {
-						ind[count] = i * dim2 + j * dim + v;
-						val[count++] = 1.0;
-					}
-				}
-
-				error = GRBaddconstr(model, dim, ind, val, GRB_EQUAL, 1.0, NULL);
-				if (error) goto ERROR;
-			}
-		}
-	}
-
 	/* Optimize model */
 	error = GRBoptimize(model);
 	if (error) goto ERROR;
@@ -0,0 +1,256 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "ParallelCounter.h"
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "exhBacktr.h"
+#include "../utils/MemAlloc.h"
+
+/**
+ * The search tree is split at the minimal depth that yields at least
+ * [tasksPerWorker] tasks per worker, so the stealing can balance uneven subtrees.
+ */
+#define tasksPerWorker 32
+
+/**
+ * The search tree is split into at least [tasksPerShard] tasks per shard, so the shards
+ * are balanced on average, whatever the number of the threads of every shard is.
+ */
+#define tasksPerShard 64
+
+/**
+ * This struct defines a deque of tasks, which is owned by a single worker.
+ */
+typedef struct {
+
+	/**
+	 * The tasks are tasks[top], ..., tasks[bottom - 1]. The owner takes tasks from
+	 * the bottom, and the other workers steal from the top.
+	 */
+	unsigned int *tasks;
+	unsigned int top;
+	unsigned int bottom;
+
+	pthread_mutex_t lock;
+} TaskDeque;
+
+/**
+ * This struct contains the data that is shared by the workers.
+ */
+typedef struct {
+
+	/**
+	 * The counted board.
+	 */
+	Puzzle *puzzle;
+
+	/**
+	 * The number of the cells that every task assigns.
+	 */
+	unsigned int depth;
+
+	/**
+	 * The assignments of the tasks: the task t assigns the value prefixes[2 * (t * depth + k) + 1]
+	 * to the cell prefixes[2 * (t * depth + k)], for every k < depth.
+	 */
+	unsigned int *prefixes;
+
+	/**
+	 * The number of the tasks that have been recorded in [prefixes].
+	 */
+	unsigned int tasksNum;
+
+	/**
+	 * The deques of the workers.
+	 */
+	TaskDeque *deques;
+	unsigned int workersNum;
+} TaskPool;
+
+/**
+ * This struct defines a single worker.
+ */
+typedef struct {
+	TaskPool *pool;
+	unsigned int id;
+	pthread_t thread;
+
+	/**
+	 * The number of the solutions in the tasks that the worker has completed.
+	 */
+	uint64_t count;
+} Worker;
+
+unsigned int onlineProcessorsNum() {
+	long num = sysconf(_SC_NPROCESSORS_ONLN);
+	return num >= 1 ? (unsigned int) num : 1;
+}
+
+/**
+ * This method is the onTask function of splitBacktracking that counts the tasks.
+ */
+static void countTask(BacktrackEngine *engine, void *arg) {
+	if (engine) {
+	}
+	(*(unsigned int*) arg)++;
+}
+
+/**
+ * This method is the onTask function of splitBacktracking that records the
+ * assignments of the tasks in pool->prefixes.
+ */
+static void recordTask(BacktrackEngine *engine, void *arg) {
+	TaskPool *pool = arg;
+	unsigned int k, c, *prefix = pool->prefixes + 2 * pool->tasksNum++ * pool->depth;
+
+	for (k = 0; k < pool->depth; k++) {
+		c = engine->frames[k].cell;
+		prefix[2 * k] = c;
+		prefix[2 * k + 1] = engine->value[c];
+	}
+}
+
+/**
+ * This method takes the next task of a worker: from the bottom of its own deque,
+ * or from the top of the deque of another worker.
+ *
+ * Returns:
+ * FALSE iff all the deques are empty
+ */
+static Bool takeTask(Worker *worker, unsigned int *task) {
+	TaskPool *pool = worker->pool;
+	TaskDeque *deque;
+	unsigned int k;
+	Bool found = FALSE;
+
+	for (k = 0; k < pool->workersNum && !found; k++) {
+		deque = pool->deques + (worker->id + k) % pool->workersNum;
+		pthread_mutex_lock(&deque->lock);
+		if (deque->bottom > deque->top) {
+			*task = k == 0 ? deque->tasks[--deque->bottom] : deque->tasks[deque->top++];
+			found = TRUE;
+		}
+		pthread_mutex_unlock(&deque->lock);
+	}
+
+	return found;
+}
+
+/**
+ * This method is the main function of the worker threads.
+ * Since the tasks do not create new tasks, the worker finishes as soon as
+ * it fails to take a task.
+ */
+static void *runWorker(void *arg) {
+	Worker *worker = arg;
+	TaskPool *pool = worker->pool;
+	unsigned int task, k, *prefix;
+	BacktrackEngine *engine = createBacktrackEngine(pool->puzzle->n, pool->puzzle->m, cellOrderMRV);
+
+	while (takeTask(worker, &task)) {
+		loadBacktrackEngine(engine, pool->puzzle);
+		prefix = pool->prefixes + 2 * task * pool->depth;
+		for (k = 0; k < pool->depth; k++) {
+			assumeBacktrackValue(engine, prefix[2 * k], prefix[2 * k + 1]);
+		}
+		worker->count += exhaustiveBacktracking(engine);
+	}
+
+	destroyBacktrackEngine(engine);
+	return 0;
+}
+
+/**
+ * This method splits the search tree of p into at least [minTasks] tasks (or as many as
+ * there are), and counts the solutions of the tasks t with t % shardsNum == shard by
+ * [threadsNum] workers. The split depends only on p and [minTasks], so every shard sees
+ * the same tasks. The solutions that are found above the split belong to the shard 0.
+ */
+static uint64_t poolBacktracking(Puzzle *p, unsigned int minTasks, unsigned int shard,
+		unsigned int shardsNum, unsigned int threadsNum) {
+	unsigned int k, t, tasksNum = 0;
+	uint64_t count;
+	TaskPool pool;
+	Worker *workers;
+	BacktrackEngine *engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+
+	for (pool.depth = 1; ; pool.depth++) {
+		tasksNum = 0;
+		loadBacktrackEngine(engine, p); /* the MRV ties are broken by the order of the open cells */
+		splitBacktracking(engine, pool.depth, countTask, &tasksNum);
+		if (tasksNum >= minTasks || pool.depth + 1 >= engine->openNum) {
+			break;
+		}
+	}
+
+	pool.puzzle = p;
+	pool.tasksNum = 0;
+	pool.workersNum = threadsNum;
+	memAllocN(pool.prefixes, unsigned int, 2 * pool.depth * tasksNum + 1);
+	loadBacktrackEngine(engine, p);
+	count = splitBacktracking(engine, pool.depth, recordTask, &pool);
+	assert(pool.tasksNum == tasksNum);
+	destroyBacktrackEngine(engine);
+	if (shard) {
+		count = 0;
+	}
+
+	memAllocN(pool.deques, TaskDeque, threadsNum);
+	memAllocN(workers, Worker, threadsNum);
+	for (k = 0; k < threadsNum; k++) {
+		memAllocN(pool.deques[k].tasks, unsigned int, tasksNum / threadsNum + 1);
+		pool.deques[k].top = 0;
+		pool.deques[k].bottom = 0;
+		pthread_mutex_init(&pool.deques[k].lock, 0);
+	}
+	for (t = shard, k = 0; t < tasksNum; t += shardsNum, k = (k + 1) % threadsNum) {
+		pool.deques[k].tasks[pool.deques[k].bottom++] = t;
+	}
+
+	for (k = 0; k < threadsNum; k++) {
+		workers[k].pool = &pool;
+		workers[k].id = k;
+		workers[k].count = 0;
+		if (pthread_create(&workers[k].thread, 0, runWorker, workers + k)) {
+			fatalError("pthread_create");
+		}
+	}
+	for (k = 0; k < threadsNum; k++) {
+		pthread_join(workers[k].thread, 0);
+		count += workers[k].count;
+	}
+
+	for (k = 0; k < threadsNum; k++) {
+		pthread_mutex_destroy(&pool.deques[k].lock);
+		memFree(pool.deques[k].tasks);
+	}
+	memFree(pool.deques);
+	memFree(workers);
+	memFree(pool.prefixes);
+	return count;
+}
+
+uint64_t parallelBacktracking(Puzzle *p, unsigned int threadsNum) {
+	uint64_t count;
+	BacktrackEngine *engine;
+
+	assert(threadsNum >= 1);
+	if (threadsNum == 1) {
+		engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+		loadBacktrackEngine(engine, p);
+		count = exhaustiveBacktracking(engine);
+		destroyBacktrackEngine(engine);
+		return count;
+	}
+
+	return poolBacktracking(p, tasksPerWorker * threadsNum, 0, 1, threadsNum);
+}
+
+uint64_t shardBacktracking(Puzzle *p, unsigned int shard, unsigned int shardsNum, unsigned int threadsNum) {
+	assert(shard < shardsNum && threadsNum >= 1);
+	return poolBacktracking(p, tasksPerShard * shardsNum, shard, shardsNum, threadsNum);
+}
+
+#undef tasksPerWorker
+#undef tasksPerShard
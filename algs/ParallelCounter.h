@@ -0,0 +1,61 @@
+#ifndef __ALGS_PARALLELCOUNTER_H
+#define __ALGS_PARALLELCOUNTER_H
+/**
+ * This module counts the solutions of a board with several threads.
+ * The search tree is split at a shallow depth into tasks (the assignments of the
+ * first empty cells), and the tasks are distributed over per-thread deques.
+ * Every worker has its own solution counter; it takes tasks from the bottom of
+ * its own deque, and when it runs out of them it steals from the top of the
+ * deques of the other workers.
+ * The same split partitions a count into shards that separate processes may count.
+ */
+
+#include <stdint.h>
+#include "../dataStructures/Puzzle.h"
+
+/**
+ * This method returns the number of the processors that are online,
+ * which is the default number of the threads.
+ */
+unsigned int onlineProcessorsNum();
+
+/**
+  * This method returns the number of possible solutions for the given puzzle,
+  * using [threadsNum] threads. The result is identical to the result of
+  * exhaustiveBacktracking; the counts of the threads are summed into a 64-bit total.
+  *
+  * Parameters:
+  * Puzzle *p
+  * unsigned int threadsNum - The number of the threads
+  *
+  * Preconditions:
+  * p != 0
+  * p->n * p->m ≤ maxMaskDim
+  * isPuzzleLegal(p)
+  * threadsNum ≥ 1
+  */
+uint64_t parallelBacktracking(Puzzle *p, unsigned int threadsNum);
+
+/**
+  * This method counts the solutions in a single shard of the search tree of the given puzzle.
+  * The search tree is split into tasks by a prefix partition that depends only on the puzzle
+  * and on [shardsNum], and the shard k gets the tasks t with t % shardsNum == k.
+  * Hence independent processes may count the shards, and the sum of the counts of the shards
+  * 0, ..., shardsNum - 1 is the number of the solutions.
+  *
+  * Parameters:
+  * Puzzle *p
+  * unsigned int shard - The index of the shard
+  * unsigned int shardsNum - The number of the shards
+  * unsigned int threadsNum - The number of the threads that count the shard
+  *
+  * Preconditions:
+  * p != 0
+  * p->n * p->m ≤ maxMaskDim
+  * isPuzzleLegal(p)
+  * shard < shardsNum
+  * threadsNum ≥ 1
+  */
+uint64_t shardBacktracking(Puzzle *p, unsigned int shard, unsigned int shardsNum, unsigned int threadsNum);
+
+#endif
@@ -1,154 +1,110 @@
 #include "SudokuAlgs.h"
 #include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include "exhBacktr.h"
-#include "ILPSolver.h"
+#include "ParallelCounter.h"
+#include "DLXSolver.h"
+#include "../dataStructures/Geometry.h"
 #include "../utils/MemAlloc.h"
 
-#define generateMaxTrials 1000
-
-Puzzle* copyPuzzle(Puzzle* puzzle) {
-	unsigned int i, j;
-	unsigned int size = puzzle->m * puzzle->n;
-	Puzzle* localP = createPuzzle(puzzle->n, puzzle->m);
-	localP->zeroCnt = puzzle->zeroCnt;
-	for (i = 0; i < size; i++) {
-		for (j = 0; j < size; j++) {
-			localP->board[i][j][0] = puzzle->board[i][j][0];
-			if (getBoardValue(puzzle, i, j)) {
-				fixCell(localP, i, j);
-			}
-		}
-	}
-	return localP;
-}
+#ifdef USE_GUROBI
+#include "ILPSolver.h"
+#endif
 
+#define generateMaxTrials 1000
+#define checkpointTmpSuffix ".tmp"
 
 /**
-  *This method sets RowValues to contain the values in the same row of (x,y), excluding (x,y) itself.
-  *
-  *Parameters:
-  *Puzzle *puzzle
-  *unsigned int x - The row
-  *unsigned int y - The column
-  *unsigned int *RowValues - An array whose size is n*m - 1
-  *
-  *Preconditions:
-  *puzzle != 0
-  *x,y < n*m
-  *RowValues is an array of size n*m - 1
-  *
-  *Postconditions:
-  *RowValues contains all the values in the row x, excluding the value of cell (x,y)
-  */
-static void getRowValues(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int *RowValues) {
-	unsigned int i;
-	unsigned int count = 0;
-	for (i = 0; i < puzzle->m*puzzle->n; i++) {
-		if (i != y)
-			RowValues[count++] = getBoardValue(puzzle, x, i);
-	}
-}
+ * A random fill of a board is restarted after [generateRestartNodes] decisions per cell.
+ */
+#define generateRestartNodes 4
 
 /**
-  *This method sets ColValues to contain the values in the same column of (x,y), excluding (x,y) itself.
-  *
-  *Parameters:
-  *Puzzle *puzzle
-  *unsigned int x - The row
-  *unsigned int y - The column
-  *unsigned int *ColValues - An array whose size is n*m - 1
-  *
-  *Preconditions:
-  *puzzle != 0
-  *x,y < n*m
-  *ColValues is an array of size n*m - 1
-  *
-  *Postconditions:
-  *ColValues contains all the values in the column y, excluding the value of cell (x,y)
-  */
-static void getColValues(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int *ColValues) {
-	unsigned int i;
-	unsigned int count = 0;
-	for (i = 0; i < puzzle->m*puzzle->n; i++) {
-		if (i != x)
-			ColValues[count++] = getBoardValue(puzzle, i, y);
-	}
+ * This method solves p using the solver that the program was built with:
+ * the ILP solver if it was built with Gurobi, otherwise the constraint propagation
+ * solver, whose bitset candidates fit boards of any size.
+ *
+ * Preconditions:
+ * p != 0
+ *
+ * Returns:
+ * TRUE iff [p] is solvable
+ *
+ * Postconditions:
+ * [p] is filled with values iff TRUE is returned
+ */
+static Bool solvePuzzle(Puzzle *p) {
+#ifdef USE_GUROBI
+	return ILPSolver(p);
+#else
+	return CPSolver(p, 0);
+#endif
 }
 
-/**
-  *This method sets BlockValues to contain the values in the same block of (x,y), excluding (x,y) itself.
-  *
-  *Parameters:
-  *Puzzle *puzzle
-  *unsigned int x - The row
-  *unsigned int y - The column
-  *unsigned int *BlockValues - An array whose size is n*m - 1
-  *
-  *Preconditions:
-  *puzzle != 0
-  *x,y < n*m
-  *BlockValues is an array of size n*m - 1
-  *
-  *Postconditions:
-  *BlockValues contains all the values in the block of the cell (x,y), excluding the value of cell (x,y)
-  */
-static void getBlockValues(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int* BlockValues) {
-	unsigned int BlockRow = x / puzzle->n;
-	unsigned int BlockCol = y / puzzle->m;
-	unsigned int i, j;
-	int count = 0;
-	for (i = BlockRow * puzzle->n; i < (BlockRow + 1)*puzzle->n; i++)
-		for (j = BlockCol * puzzle->m; j < (BlockCol + 1)*puzzle->m; j++)
-			if (i != x || j != y)
-				BlockValues[count++] = getBoardValue(puzzle, i, j);
-}
 
 Bool isCellValueLegal(Puzzle *p, unsigned int x, unsigned int y, unsigned int CellValue) {
-	unsigned int BlockSize = p->m  *p->n;
-	unsigned int i;
-	unsigned int *memAllocN(Values, unsigned int, BlockSize - 1);
-	getRowValues(p, x, y, Values);
-	for (i = 0; i < BlockSize - 1; i++)
-		if (Values[i] == CellValue) {
-			memFree(Values);
-			return FALSE;
-		}
-	getColValues(p, x, y, Values);
-	for (i = 0; i < BlockSize - 1; i++)
-		if (Values[i] == CellValue) {
-			memFree(Values);
-			return FALSE;
-		}
-	getBlockValues(p, x, y, Values);
-	for (i = 0; i < BlockSize - 1; i++)
-		if (Values[i] == CellValue) {
-			memFree(Values);
+	unsigned int dim = p->m * p->n;
+	unsigned int b = getBlockIndex(p, x, y);
+	unsigned int own = getBoardValue(p, x, y) == CellValue; /* (x,y) itself is not counted */
+	return p->rowCnt[x * dim + CellValue - 1] == own
+		&& p->colCnt[y * dim + CellValue - 1] == own
+		&& p->blockCnt[b * dim + CellValue - 1] == own;
+}
+
+#ifdef DEBUG_CROSSCHECK
+/**
+ * This method returns true iff the cell (x,y) contains a legal value.
+ * Unlike isCellLegal, it scans the peers of the cell instead of using the maintained counters.
+ */
+static Bool isCellLegalScan(Puzzle *p, unsigned int x, unsigned int y) {
+	const Geometry *geometry = getGeometry(p->n, p->m);
+	unsigned int dim = geometry->dim, v = getBoardValue(p, x, y), k;
+	const unsigned int *peer = geometry->peers + (x * dim + y) * geometry->peersNum;
+	if (!v) {
+		return TRUE;
+	}
+	for (k = 0; k < geometry->peersNum; k++) {
+		if (p->cells[peer[k]] == v) {
 			return FALSE;
 		}
-	memFree(Values);
+	}
 	return TRUE;
 }
 
-Bool isPuzzleLegal(Puzzle *p) {
+/**
+ * This method is the full-scan version of isPuzzleLegal.
+ */
+static Bool isPuzzleLegalScan(Puzzle *p) {
 	unsigned int i, j;
 	for (i = 0; i < p->m*p->n; i++)
 		for (j = 0; j < p->m*p->n; j++) {
-			if (!isCellLegal(p, i, j))
+			if (!isCellLegalScan(p, i, j))
 				return FALSE;
 		}
 	return TRUE;
 }
+#endif
+
+Bool isPuzzleLegal(Puzzle *p) {
+#ifdef DEBUG_CROSSCHECK
+	assert((p->conflictCnt == 0) == isPuzzleLegalScan(p));
+#endif
+	return p->conflictCnt == 0;
+}
 
 Bool isPuzzleValid(Puzzle *p) {
 	Puzzle *pclone = clonePuzzle(p);
-	Bool solvable = ILPSolver(pclone);
+	Bool solvable = solvePuzzle(pclone);
 	destroyPuzzle(pclone);
 	return solvable;
 }
 
 unsigned int calcCellHint(Puzzle *p, unsigned int x, unsigned int y) {
 	Puzzle *pclone = clonePuzzle(p);
-	Bool solvable = ILPSolver(pclone);
+	Bool solvable = solvePuzzle(pclone);
 	unsigned int ret = 0;
 	if (solvable) {
 		ret = getBoardValue(pclone, x, y);
@@ -158,275 +114,400 @@ unsigned int calcCellHint(Puzzle *p, unsigned int x, unsigned int y) {
 }
 
 /**
- * This method zeros all the values in a given puzzle.
+ * This method randomly zeros [cellsNum - y] non-zero values of a grid.
+ * The clues are chosen on the grid, so the legality counters of a puzzle are updated
+ * only for the [y] clues that are set in it, and not for every value of the solution.
  *
  * Parameters:
- * Puzzle *p - A pointer to the puzzle that would be cleared
- *
- * Postconditions:
- * ∀i,j: 0 <= i,j <= p->n * p->m → getBoardValue(p, i, j) == 0
+ * unsigned int *values - The values of a full grid
+ * unsigned int cellsNum - The number of the cells of the grid
+ * unsigned int y - number of cells that would remain non-zero
+ * Rng *rng - The generator of the random choices
  */
-static void clearBoard(Puzzle *p) {
-	unsigned int i, j, dim;
-	dim = p->n * p->m;
-	for (i = 0; i < dim; i++) {
-		for (j = 0; j < dim; j++) {
-			setBoardValue(p, i, j, 0);
-		}
+static void clearBut(unsigned int *values, unsigned int cellsNum, unsigned int y, Rng *rng) {
+	unsigned int c, count;
+
+	for (count = y; count < cellsNum; count++) {
+		do {
+			c = rngBelow(rng, cellsNum);
+		} while (!values[c]);
+
+		values[c] = 0;
 	}
 }
 
 /**
- * This method returns a pointer to a dynamically allocated array
- * that contains all the legal values for a certain cell.
- *
- * Parameters:
- * Puzzle *p
- * unsigned int x - the row
- * unsigned int y - the column
- *
- * Preconditions:
- * x,y <= p->n * p->m
- *
- * Returns:
- * A pointer to a dynamically allocated array that contains all the legal
- * values for the cell (x,y). The last cell in the array is 0.
+ * This method sets the non-zero values of a grid in the corresponding cells of an empty puzzle.
  */
-static unsigned int *possibleVals(Puzzle *p, unsigned int x, unsigned int y) {
-	unsigned int *rowValues, *colValues, *blockValues, *ret;
-	unsigned char *options;
-	unsigned int dim = p->n * p->m, count = dim, i, j;
-	memAllocN(rowValues, unsigned int, dim);
-	memAllocN(colValues, unsigned int, dim);
-	memAllocN(blockValues, unsigned int, dim);
-	memAllocN(options, unsigned char, dim);
-	getRowValues(p, x, y, rowValues);
-	getColValues(p, x, y, colValues);
-	getBlockValues(p, x, y, blockValues);
-
-	for (i = 0; i < dim; i++) { /* options[i] == 1 iff (i - 1) is illegal */
-		if (rowValues[i] != 0 && !options[rowValues[i] - 1]) {
-			options[rowValues[i] - 1] = 1;
-			count--;
-		}
-		if (colValues[i] != 0 && !options[colValues[i] - 1]) {
-			options[colValues[i] - 1] = 1;
-			count--;
-		}
-		if (blockValues[i] != 0 && !options[blockValues[i] - 1]) {
-			options[blockValues[i] - 1] = 1;
-			count--;
+static void setGridValues(Puzzle *p, const unsigned int *values) {
+	unsigned int c, dim = p->n * p->m;
+
+	for (c = 0; c < dim * dim; c++) {
+		if (values[c]) {
+			setBoardValue(p, c / dim, c % dim, values[c]);
 		}
 	}
+}
 
-	memAllocN(ret, unsigned int, count + 1);
-	for (i = 0, j = 0; i < dim; i++) {
-		if (!options[i]) {
-			ret[j++] = i + 1;
-		}
+Generator *createGenerator(unsigned int n, unsigned int m, uint64_t seed) {
+	Generator *memAlloc(gen, Generator);
+
+	gen->n = n;
+	gen->m = m;
+	seedRng(&gen->rng, seed);
+	gen->bank = getGridBank(n, m);
+	gen->engine = 0;
+	if (n * m <= maxMaskDim) {
+		gen->engine = createCPEngine(n, m);
+		gen->engine->rng = &gen->rng;
+		gen->engine->nodesLimit = generateRestartNodes * gen->engine->cellsNum;
 	}
+	memAllocN(gen->values, unsigned int, n * m * n * m);
+	memAllocN(gen->transformScratch, unsigned int, transformScratchLen(n, m));
+	return gen;
+}
 
-	free(rowValues);
-	free(colValues);
-	free(blockValues);
-	free(options);
+void destroyGenerator(Generator *gen) {
+	if (gen->engine) {
+		destroyCPEngine(gen->engine);
+	}
+	memFree(gen->values);
+	memFree(gen->transformScratch);
+	memFree(gen);
+}
 
-	return ret;
+/**
+ * This method stores a random transform of a base grid in gen->values: a random grid
+ * of gen->bank, or the pattern grid if there is no bank.
+ */
+static void findTransformedGrid(Generator *gen) {
+	unsigned int dim = gen->n * gen->m;
+	unsigned int *values = gen->values;
+
+	if (gen->bank) {
+		memcpy(values, gen->bank->grids + rngBelow(&gen->rng, gen->bank->gridsNum) * dim * dim,
+				dim * dim * sizeof(unsigned int));
+	} else {
+		fillPatternGrid(gen->n, gen->m, values);
+	}
+	transformGrid(gen->n, gen->m, values, gen->transformScratch, &gen->rng);
 }
 
 /**
- * This method receives an empty puzzle and an unsigned integer x,
- * and randomly fills [x] cells with legal values.
- * If one of the randomly selected cells cannot be filled,
- * the board is cleaned and the returned value is FALSE.
+ * This method finds a random solution of an empty puzzle, by a single search of the
+ * constraint propagation solver that tries the values in a random order.
+ * A search that runs into a long dead end is restarted.
+ * The boards wider than maxMaskDim, whose random searches hardly ever end, take a random
+ * transform of a base grid instead (see findTransformedGrid).
  *
  * Parameters:
+ * Generator *gen
  * Puzzle *p
- * unsigned int x - the number of the cells to fill
  *
  * Preconditions:
  * p points an empty board
- * x <= p->n * p->m
  *
  * Returns:
- * TRUE iff the board has been filled successfully
+ * TRUE iff a solution has been found. In this case gen->values contains it, and [p] is unchanged.
  */
-static Bool fillRndVals(Puzzle *p, unsigned int x) {
-	unsigned int i, j, count = 0, vind;
-	unsigned int dim = p->n * p->m;
-	unsigned int *vals, valslen = 0;
+static Bool findRndSolution(Generator *gen, Puzzle *p) {
+	unsigned int t;
+	Bool ret = FALSE;
+	CPEngine *engine = gen->engine;
 
-	if (!x) {
+	if (!engine) {
+		findTransformedGrid(gen);
 		return TRUE;
 	}
-
-	while (count < x) {
-		i = rand() % dim;
-		j = rand() % dim;
-		if (!getBoardValue(p, i, j)) {
-			vals = possibleVals(p, i, j);
-			valslen = 0;
-			while (vals[valslen++]); valslen--;
-
-			if (!valslen) { /* no possible values for this cell */
-				free(vals);
-				clearBoard(p);
-				return FALSE;
-			} else {
-				vind = rand() % valslen;
-				setBoardValue(p, i, j, vals[vind]);
-				count++;
-			}
-
-			free(vals);
-		}
+	for (t = 0; t < generateMaxTrials && !ret; t++) {
+		ret = loadCPEngine(engine, p) && searchCPEngine(engine);
+	}
+	if (ret) {
+		memcpy(gen->values, engine->value, engine->cellsNum * sizeof(unsigned int));
 	}
 
-	return TRUE;
+	return ret;
 }
 
 /**
- * This method randomly zeros [(p->n * p->m) ^ 2 - y] cells from [p];
+ * This method fills an empty puzzle with a random solution, see findRndSolution.
  *
- * Parameters:
- * Puzzle *p
- * unsigned int y - number of cells that would remain non-zero
+ * Returns:
+ * TRUE iff the board has been filled
  */
-static void clearBut(Puzzle *p, unsigned int y) {
-	unsigned int dim = p->n * p->m, dim2 = dim * dim, i, j, count;
-
-	if (y == dim2) {
-		return;
+static Bool fillRndSolution(Generator *gen, Puzzle *p) {
+	if (!findRndSolution(gen, p)) {
+		return FALSE;
 	}
+	setGridValues(p, gen->values);
+	return TRUE;
+}
 
-	for (count = 0; count < dim2 - y; count++) {
-		do {
-			i = rand() % dim;
-			j = rand() % dim;
-		} while (!getBoardValue(p, i, j));
+Bool generateRandomPuzzle(Generator *gen, Puzzle *p, unsigned int y) {
+	unsigned int dim = p->n * p->m;
 
-		setBoardValue(p, i, j, 0);
+	if (gen->bank) {
+		findTransformedGrid(gen);
+	} else if (!findRndSolution(gen, p)) {
+		return FALSE;
 	}
+
+	clearBut(gen->values, dim * dim, y, &gen->rng);
+	setGridValues(p, gen->values);
+	return TRUE;
 }
 
-Bool generatePuzzle(Puzzle *p, unsigned int x, unsigned int y) {
-	unsigned int t;
+Bool generatePuzzle(Puzzle *p, unsigned int x, unsigned int y, Rng *rng) {
+	Bool ret;
+	Generator *gen = createGenerator(p->n, p->m, nextRng(rng));
 
 	assert(y > 0);
 
-	for (t = 0; t < generateMaxTrials; t++) {
-		if (!fillRndVals(p, x) || !ILPSolver(p)) {
-			clearBoard(p);
-			continue;
+	if (x) { /* the random cells of the solution are the random choices of the fill */
+	}
+	ret = generateRandomPuzzle(gen, p, y);
+
+	destroyGenerator(gen);
+	return ret;
+}
+
+Bool buildGridBank(unsigned int n, unsigned int m, unsigned int gridsNum, Rng *rng) {
+	unsigned int g, dim = n * m;
+	unsigned int *grids;
+	Bool ret = TRUE;
+	Puzzle *p = createPuzzle(n, m);
+	Generator *gen = createGenerator(n, m, nextRng(rng));
+
+	memAllocN(grids, unsigned int, gridsNum * dim * dim);
+	for (g = 0; g < gridsNum && ret; g++) {
+		ret = findRndSolution(gen, p);
+		memcpy(grids + g * dim * dim, gen->values, dim * dim * sizeof(unsigned int));
+	}
+	destroyGenerator(gen);
+	ret = ret && writeGridBank(n, m, grids, gridsNum);
+
+	memFree(grids);
+	destroyPuzzle(p);
+	return ret;
+}
+
+/**
+ * This method checks whether a puzzle that has a single solution keeps it when the value v
+ * is removed from the cell c. The solution is the witness: any other solution of the reduced
+ * puzzle has to assign another value to c, so a single search for such a solution decides.
+ *
+ * Preconditions:
+ * The cell c of [p] is empty, and p with the value v in c has a single solution
+ *
+ * Returns:
+ * TRUE iff [p] has a single solution
+ */
+static Bool isRemovalUnique(CPEngine *engine, Puzzle *p, unsigned int c, unsigned int v) {
+	return !loadCPEngine(engine, p) || !excludeCPValue(engine, c, v) || !searchCPEngine(engine);
+}
+
+unsigned int generateUniquePuzzle(Puzzle *p, unsigned int y, double seconds, Rng *rng) {
+	unsigned int dim = p->n * p->m, cellsNum = dim * dim, k, c, v, clues = cellsNum;
+	unsigned int *order;
+	clock_t deadline = clock() + (clock_t) (seconds * CLOCKS_PER_SEC);
+	CPEngine *engine;
+	Generator *gen = createGenerator(p->n, p->m, nextRng(rng));
+
+	if (!fillRndSolution(gen, p)) {
+		destroyGenerator(gen);
+		return 0;
+	}
+
+	order = gen->values;
+	for (k = 0; k < cellsNum; k++) {
+		order[k] = k;
+	}
+	rngShuffle(&gen->rng, order, cellsNum); /* a random order of the cells */
+
+	engine = createCPEngine(p->n, p->m);
+	for (k = 0; k < cellsNum && clues > y && clock() < deadline; k++) {
+		c = order[k];
+		v = p->cells[c];
+		setBoardValue(p, c / dim, c % dim, 0);
+		if (isRemovalUnique(engine, p, c, v)) {
+#ifdef DEBUG_CROSSCHECK
+			assert(calcSolutionsNumBounded(p, 2) == 1);
+#endif
+			clues--;
 		} else {
-			clearBut(p, y);
-			return TRUE;
+			setBoardValue(p, c / dim, c % dim, v);
 		}
 	}
 
-	clearBoard(p);
-	return FALSE;
+	destroyCPEngine(engine);
+	destroyGenerator(gen);
+	return clues;
 }
 
-Bool proceed(Puzzle *puzzle, unsigned int *i, unsigned int *j, unsigned int puzzleSize) {
-	unsigned int a = *i;
-	unsigned int b = *j;
-	if (*i == puzzleSize - 1 && *j == puzzleSize - 1)
-		return FALSE;
-	while (a < puzzleSize - 1 || b < puzzleSize - 1) {
-		if (b == puzzleSize - 1) {
-			b = 0;
-			a++;
-		} else
-			b++;
-		if (!isCellFixed(puzzle, a, b)) {
-			*i = a;
-			*j = b;
-			return TRUE;
-		}
+uint64_t calcSolutionsNum(Puzzle *p, unsigned int threadsNum) {
+	if (p->m * p->n > maxMaskDim) {
+		return DLXCountSolutions(p, ULONG_MAX);
 	}
-	return FALSE;
+	return parallelBacktracking(p, threadsNum ? threadsNum : onlineProcessorsNum());
 }
 
-Bool precede(Puzzle *puzzle, unsigned int *i, unsigned int *j, unsigned int puzzleSize) {
-	unsigned int a = *i;
-	unsigned int b = *j;
-	if (*i == 0 && *j == 0)
-		return FALSE;
-	while (a > 0 || b > 0) {
-		if (b == 0) {
-			b = puzzleSize - 1;
-			a--;
-		} else
-			b--;
-		if (!isCellFixed(puzzle, a, b)) {
-			*i = a;
-			*j = b;
-			return TRUE;
-		}
+unsigned long calcMarginals(Puzzle *p, unsigned long limit, unsigned long *marginals) {
+	unsigned long ret;
+	BacktrackEngine *engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+	loadBacktrackEngine(engine, p);
+	ret = marginalBacktracking(engine, limit, marginals);
+	destroyBacktrackEngine(engine);
+	return ret;
+}
+
+unsigned long enumerateSolutions(Puzzle *p, unsigned long limit,
+		void (*onSolution)(const unsigned int *values, void *arg), void *arg) {
+	unsigned long ret;
+	BacktrackEngine *engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+	loadBacktrackEngine(engine, p);
+	ret = enumerateBacktracking(engine, limit, onSolution, arg);
+	destroyBacktrackEngine(engine);
+	return ret;
+}
+
+/**
+ * This struct is the argument of writeCheckpoint.
+ */
+typedef struct {
+	char *path;
+	char *tmpPath;
+
+	/**
+	 * TRUE iff every checkpoint has been written successfully.
+	 */
+	Bool written;
+
+	/**
+	 * TRUE iff a checkpoint has replaced [path].
+	 */
+	Bool created;
+} CheckpointFile;
+
+/**
+ * This method is the onCheckpoint function of calcSolutionsNumResumable, which replaces
+ * the checkpoint file with the current state of the search.
+ */
+static void writeCheckpoint(BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg) {
+	CheckpointFile *file = arg;
+	Bool saved;
+	FILE *fp = fopen(file->tmpPath, "w");
+
+	if (!fp) {
+		file->written = FALSE;
+		return;
+	}
+	saved = saveBacktrackState(engine, depth, count, fp);
+	if (fclose(fp) || !saved || rename(file->tmpPath, file->path)) {
+		remove(file->tmpPath);
+		file->written = FALSE;
+	} else {
+		file->created = TRUE;
 	}
-	return FALSE;
 }
 
-unsigned int calcSolutionsNum(Puzzle *p) {
-	unsigned int i = 0, j = 0;
-	unsigned int size = p->m*p->n;
-	int ret;
-	Puzzle *localP;
-
-	localP = copyPuzzle(p);
-	if (isCellFixed(localP, i, j))
-		if (proceed(localP, &i, &j, size) == FALSE) {
-			destroyPuzzle(localP);
-			return 1;
-		}
-	ret = exhaustiveBacktracking(localP, i, j);
-	destroyPuzzle(localP);
+/**
+ * This method checks whether a file starts with backtrackStateHeader, and rewinds it.
+ */
+static Bool isCheckpointFile(FILE *fp) {
+	char header[sizeof(backtrackStateHeader)];
+	Bool ret = fgets(header, sizeof(header), fp) && !strcmp(header, backtrackStateHeader);
+
+	rewind(fp);
+	return ret;
+}
+
+ResumableStatus calcSolutionsNumResumable(Puzzle *p, char *path, unsigned long nodes, double seconds,
+		unsigned long *count, Bool *resumed) {
+	CheckpointFile file;
+	unsigned int depth;
+	BacktrackEngine *engine;
+	FILE *fp = fopen(path, "r");
+
+	*count = 0;
+	*resumed = FALSE;
+	if (fp && !isCheckpointFile(fp)) { /* never overwrite a file that is not a checkpoint */
+		fclose(fp);
+		return resumableNotCheckpoint;
+	}
+
+	engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+	memAllocN(file.tmpPath, char, strlen(path) + strlen(checkpointTmpSuffix) + 1);
+	strcat(strcpy(file.tmpPath, path), checkpointTmpSuffix);
+	file.path = path;
+	file.written = TRUE;
+	file.created = FALSE;
+
+	loadBacktrackEngine(engine, p);
+	if (fp) {
+		*resumed = loadBacktrackState(engine, fp, &depth, count);
+		fclose(fp);
+	}
+
+	if (*resumed) {
+		*count = resumeBacktracking(engine, depth, *count, nodes, seconds, writeCheckpoint, &file);
+	} else {
+		*count = checkpointedBacktracking(engine, nodes, seconds, writeCheckpoint, &file);
+	}
+	if (*resumed || file.created) { /* a checkpoint of another board that was not replaced is kept */
+		remove(path);
+	}
+
+	memFree(file.tmpPath);
+	destroyBacktrackEngine(engine);
+	return file.written ? resumableWritten : resumableWriteFailed;
+}
+
+void estimateSolutionsNum(Puzzle *p, unsigned long samples, double seconds, Rng *rng, CountEstimate *res) {
+	BacktrackEngine *engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+	loadBacktrackEngine(engine, p);
+	estimateBacktracking(engine, samples, seconds, rng, res);
+	destroyBacktrackEngine(engine);
+}
+
+unsigned long calcSolutionsNumBounded(Puzzle *p, unsigned long limit) {
+	unsigned long ret;
+	BacktrackEngine *engine;
+
+	if (p->m * p->n > maxMaskDim) {
+		return DLXCountSolutions(p, limit);
+	}
+
+	engine = createBacktrackEngine(p->n, p->m, cellOrderMRV);
+	loadBacktrackEngine(engine, p);
+	ret = boundedBacktracking(engine, limit);
+	destroyBacktrackEngine(engine);
 	return ret;
 }
 
 unsigned int isSingleLegalValue(Puzzle *p, unsigned int x, unsigned int y) {
-	unsigned int i, value = 0;
-	for (i = 1; i <= p->m*p->n; i++) {
-		if (isCellValueLegal(p, x, y, i)) {
-			if (value == 0)
-				value = i;
-			else
-				return 0;
+	unsigned int w, value = 0;
+	ValueMask candidates;
+	for (w = 0; w < p->maskWords; w++) {
+		candidates = getCellCandidates(p, x, y, w);
+		if (!candidates) {
+			continue;
+		}
+		if (value || (candidates & (candidates - 1))) { /* more than one */
+			return 0;
 		}
+		value = w * maxMaskDim + lowestValue(candidates);
 	}
 	return value;
 }
 
 Bool isCellLegal(Puzzle *p, unsigned int x, unsigned int y) {
-	unsigned int i;
-	unsigned int BlockSize = p->m  *p->n;
 	unsigned int CellValue = getBoardValue(p, x, y);
-	unsigned int *memAllocN(Values, unsigned int, BlockSize - 1);
-	if (getBoardValue(p, x, y) == 0) {
-		memFree(Values);
+	if (CellValue == 0) {
 		return TRUE;
 	}
-	getRowValues(p, x, y, Values);
-	for (i = 0; i < BlockSize - 1; i++)
-		if (Values[i] == CellValue) {
-			memFree(Values);
-			return FALSE;
-		}
-	getColValues(p, x, y, Values);
-	for (i = 0; i < BlockSize - 1; i++)
-		if (Values[i] == CellValue) {
-			memFree(Values);
-			return FALSE;
-		}
-	getBlockValues(p, x, y, Values);
-	for (i = 0; i < BlockSize - 1; i++)
-		if (Values[i] == CellValue) {
-			memFree(Values);
-			return FALSE;
-		}
-	memFree(Values);
-	return TRUE;
+	return isCellValueLegal(p, x, y, CellValue);
 }
 
-#undef generateMaxTrials
\ No newline at end of file
+#undef generateMaxTrials
+#undef checkpointTmpSuffix
+#undef generateRestartNodes
\ No newline at end of file
@@ -6,9 +6,61 @@
 
 #include "../utils/Boolean.h"
 #include "../dataStructures/Puzzle.h"
+#include "../utils/Rng.h"
+#include "exhBacktr.h"
+#include "CPSolver.h"
+#include "GridBank.h"
+
+/**
+ * This struct defines the state of a puzzle generator. Every generator has its own random
+ * state and scratch memory, so several generators may run in parallel threads.
+ */
+typedef struct {
+	unsigned int n;
+	unsigned int m;
+
+	/**
+	 * The generator of all the random choices of the generator.
+	 */
+	Rng rng;
+
+	/**
+	 * The bank of the solved grids of n*m blocks, 0 if there is none (see getGridBank).
+	 */
+	GridBank *bank;
+
+	/**
+	 * The randomized solver that fills the grids, 0 if n*m > maxMaskDim.
+	 */
+	CPEngine *engine;
+
+	/**
+	 * Scratch memory of (n*m)^2 values.
+	 */
+	unsigned int *values;
+
+	/**
+	 * The scratch memory of transformGrid, so a generation does not allocate memory.
+	 */
+	unsigned int *transformScratch;
+} Generator;
+
+/**
+ * This enum defines the outcome of calcSolutionsNumResumable.
+ * resumableWritten - The solutions have been counted, and every checkpoint has been written
+ * resumableWriteFailed - The solutions have been counted, but some checkpoint could not be written
+ * resumableNotCheckpoint - The checkpoint path holds a file that is not a checkpoint,
+ *                          so nothing has been counted
+ */
+typedef enum {
+	resumableWritten, resumableWriteFailed, resumableNotCheckpoint
+} ResumableStatus;
 
 /**
   *This method returns true iff every cell in the puzzle contains a legal value.
+  *It reads the conflicts counter of the puzzle, hence it takes O(1).
+  *If the program is compiled with DEBUG_CROSSCHECK, the result is asserted to be equal
+  *to the result of a full scan of the board.
   *
   * Parameters:
   * Puzzle *p
@@ -58,27 +110,227 @@ Bool isPuzzleValid(Puzzle *p);
 unsigned int calcCellHint(Puzzle *p, unsigned int x, unsigned int y);
 
 /**
- * This method generates a new sudoku puzzle.
+ * This method generates a new sudoku puzzle: it fills the board with a random solution,
+ * and then keeps [y] random cells of it.
+ * If there is a bank of solved grids of the dimensions of [p] (see GridBank), the solution is a
+ * random transform of a random grid of the bank. Otherwise, if p->n * p->m ≤ maxMaskDim, the
+ * solution is found in a single randomized search, whose random branching decisions take the
+ * place of the [x] random cells; and for larger boards it is a random transform of the pattern grid.
  *
  * Parameters:
  * Puzzle *p - An empty puzzle
  * unsigned int x, unsigned int y - randomization parameters
+ * Rng *rng - The generator that seeds the generation
+ *
+ * Returns:
+ * TRUE iff the puzzle was generated successfully.
+ */
+Bool generatePuzzle(Puzzle *p, unsigned int x, unsigned int y, Rng *rng);
+
+/**
+ * This method creates a puzzle generator for boards of n*m blocks.
+ * It reads the bank of the grids of n*m blocks (see getGridBank), hence it is not thread-safe.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * uint64_t seed - The seed of gen->rng
+ *
+ * Returns:
+ * A pointer to a new dynamically allocated generator
+ */
+Generator *createGenerator(unsigned int n, unsigned int m, uint64_t seed);
+
+/**
+ * This method destroys a generator.
+ *
+ * Preconditions:
+ * gen != 0
+ */
+void destroyGenerator(Generator *gen);
+
+/**
+ * This method generates a new sudoku puzzle like generatePuzzle, with the random state and
+ * the scratch memory of [gen]. The same state of gen->rng yields the same puzzle.
+ *
+ * Parameters:
+ * Generator *gen
+ * Puzzle *p - An empty puzzle of gen->n*gen->m blocks
+ * unsigned int y - The number of the cells that remain non-zero
  *
  * Returns:
  * TRUE iff the puzzle was generated successfully.
  */
-Bool generatePuzzle(Puzzle *p, unsigned int x, unsigned int y);
+Bool generateRandomPuzzle(Generator *gen, Puzzle *p, unsigned int y);
+
+/**
+ * This method generates a new sudoku puzzle that has a single solution. It fills the board
+ * with a random solution, and then removes the clues one by one in a random order: a removal
+ * is kept only if the puzzle still has a single solution, which is checked by a search for
+ * a second solution that differs from the known one in the removed cell.
+ * This witness search is a bounded count with the limit 2 that prunes the known solution up front,
+ * so it replaces calcSolutionsNumBounded(p, 2); if the program is compiled with DEBUG_CROSSCHECK,
+ * every kept removal is asserted to leave calcSolutionsNumBounded(p, 2) == 1.
+ * Since a clue that cannot be removed stays so when other clues are removed, a complete pass
+ * yields a minimal puzzle: no clue can be removed without losing the uniqueness.
+ *
+ * Parameters:
+ * Puzzle *p - An empty puzzle
+ * unsigned int y - The removals stop when [y] clues are left, 0 for a minimal puzzle
+ * double seconds - The processor time budget of the removals, in seconds
+ * Rng *rng - The generator that seeds the generation
+ *
+ * Returns:
+ * The number of the clues of the generated puzzle (at least [y]), or 0 if the
+ * generation has failed and the board has been left empty.
+ */
+unsigned int generateUniquePuzzle(Puzzle *p, unsigned int y, double seconds, Rng *rng);
+
+/**
+ * This method writes the bank file of the solved grids of n*m blocks (see GridBank),
+ * which generatePuzzle draws from. The grids are found by randomized searches; the grids
+ * of the boards wider than maxMaskDim are random transforms of the base grid instead.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ * unsigned int gridsNum - The number of the grids
+ * Rng *rng - The generator that seeds the searches
+ *
+ * Preconditions:
+ * gridsNum ≥ 1
+ *
+ * Returns:
+ * TRUE iff the bank has been written
+ */
+Bool buildGridBank(unsigned int n, unsigned int m, unsigned int gridsNum, Rng *rng);
 
 /**
   *This method returns the number of possible solutions for the given puzzle
   *
   *Parameters:
   *Puzzle *puzzle
+  *unsigned int threadsNum - The number of the threads that count the solutions,
+  *                          or 0 for a thread per online processor
   *
   *Preconditions:
   *puzzle != 0
+  *isPuzzleLegal(p)
+  */
+uint64_t calcSolutionsNum(Puzzle *p, unsigned int threadsNum);
+
+/**
+  *This method returns the number of possible solutions for the given puzzle, but stops
+  *as soon as [limit] solutions have been found. Hence a uniqueness check, calcSolutionsNumBounded(p, 2),
+  *returns immediately when the puzzle has many solutions.
+  *
+  *Parameters:
+  *Puzzle *puzzle
+  *unsigned long limit
+  *
+  *Preconditions:
+  *puzzle != 0
+  *isPuzzleLegal(p)
+  *limit ≥ 1
+  *
+  *Returns:
+  *The number of the solutions, or [limit] if there are at least [limit] solutions
+  */
+unsigned long calcSolutionsNumBounded(Puzzle *p, unsigned long limit);
+
+/**
+  *This method counts the solutions of the given puzzle, and computes in the same pass
+  *how many of them assign every value to every cell. See marginalBacktracking.
+  *
+  *Parameters:
+  *Puzzle *puzzle
+  *unsigned long limit - The solutions budget: the counting stops after [limit] solutions
+  *                      (ULONG_MAX for all of them)
+  *unsigned long *marginals - The number of the solutions that assign the value v to the cell
+  *                           (x,y) would be stored in marginals[(x * dim + y) * dim + v - 1]
+  *
+  *Preconditions:
+  *puzzle, marginals != 0
+  *p->n * p->m ≤ maxMaskDim
+  *isPuzzleLegal(p)
+  *limit ≥ 1
+  *[marginals] is an array of size (n*m)^3
+  *
+  *Returns:
+  *The number of the solutions that the marginals are computed over, at most [limit]
   */
-unsigned int calcSolutionsNum(Puzzle *p);
+unsigned long calcMarginals(Puzzle *p, unsigned long limit, unsigned long *marginals);
+
+/**
+  *This method streams the solutions of the given puzzle to a function, without keeping them.
+  *See enumerateBacktracking.
+  *
+  *Parameters:
+  *Puzzle *puzzle
+  *unsigned long limit - The enumeration stops after [limit] solutions (ULONG_MAX for all of them)
+  *void (*onSolution)(const unsigned int*, void*) - The function that is called for every solution,
+  *                                                with the values of the cells, row by row
+  *void *arg - The argument that is passed to [onSolution]
+  *
+  *Preconditions:
+  *puzzle, onSolution != 0
+  *p->n * p->m ≤ maxMaskDim
+  *isPuzzleLegal(p)
+  *limit ≥ 1
+  *
+  *Returns:
+  *The number of the solutions that have been enumerated
+  */
+unsigned long enumerateSolutions(Puzzle *p, unsigned long limit,
+		void (*onSolution)(const unsigned int *values, void *arg), void *arg);
+
+/**
+  *This method counts the solutions of the given puzzle like calcSolutionsNum, but it saves the
+  *state of the search to a checkpoint file periodically, so an interrupted count may be resumed.
+  *If [path] contains a checkpoint of the same puzzle, the counting is resumed from it.
+  *Every checkpoint is written to a temporary file that then replaces [path], so a crash while
+  *writing leaves the previous checkpoint intact. The file is removed when the counting completes,
+  *if it has been resumed from or written by this counting.
+  *A file that exists in [path] and does not start with backtrackStateHeader is never overwritten:
+  *the counting is not started.
+  *
+  *Parameters:
+  *Puzzle *puzzle
+  *char *path - The path of the checkpoint file
+  *unsigned long nodes - The checkpoint interval in search nodes, 0 for none
+  *double seconds - The checkpoint interval in seconds, 0 for none
+  *unsigned long *count - The number of the solutions would be stored here
+  *Bool *resumed - Whether the counting has been resumed from a checkpoint would be stored here
+  *
+  *Preconditions:
+  *puzzle, path, count, resumed != 0
+  *p->n * p->m ≤ maxMaskDim
+  *isPuzzleLegal(p)
+  *
+  *Returns:
+  *resumableNotCheckpoint if [path] is not a checkpoint file, in which case nothing is counted.
+  *Otherwise resumableWritten iff every checkpoint has been written successfully, and
+  *resumableWriteFailed if not. The count is valid either way.
+  */
+ResumableStatus calcSolutionsNumResumable(Puzzle *p, char *path, unsigned long nodes, double seconds,
+		unsigned long *count, Bool *resumed);
+
+/**
+  *This method estimates the number of possible solutions for the given puzzle by random probing,
+  *within a budget of probes and of processor time. See estimateBacktracking.
+  *
+  *Parameters:
+  *Puzzle *puzzle
+  *unsigned long samples - The maximal number of the probes
+  *double seconds - The maximal processor time, in seconds
+  *Rng *rng - The generator of the probes
+  *CountEstimate *res - The estimation would be stored here
+  *
+  *Preconditions:
+  *puzzle, rng, res != 0
+  *p->n * p->m ≤ maxMaskDim
+  *isPuzzleLegal(p)
+  *samples ≥ 1
+  */
+void estimateSolutionsNum(Puzzle *p, unsigned long samples, double seconds, Rng *rng, CountEstimate *res);
 
 /**
   * This method checks if there's only a single value that would be legal to assign to cell (x,y) and returns it.
@@ -112,11 +364,6 @@ unsigned int isSingleLegalValue(Puzzle *p, unsigned int x, unsigned int y);
   */
 Bool isCellLegal(Puzzle *p, unsigned int x, unsigned int y);
 
-/**
- * This method clones a puzzle, and fixes all the non-empty cells in the clone.
- */
-Puzzle* copyPuzzle(Puzzle* puzzle);
-
 /**
   *This method returns true iff the assignment of value CellValue to cell (x,y) would be legal
   *
@@ -132,42 +379,4 @@ Puzzle* copyPuzzle(Puzzle* puzzle);
   */
 Bool isCellValueLegal(Puzzle *p, unsigned int x, unsigned int y, unsigned int CellValue);
 
-/**
-  *This method gets an index of a cell in the board and makes it point to the next unfixed cell
-  *
-  *Parameters:
-  *Puzzle *puzzle
-  *unsigned int *i - Pointer to the row
-  *unsigned int *j - Pointer to the column
-  *unsigned int puzzleSize - The size of the puzzle
-  *
-  *Preconditions:
-  *puzzle != 0
-  **i,*j < n*m
-  *puzzleSize = n*m
-  *
-  *Returns:
-  *1 iff an unfixed cell was found
-  */
-Bool proceed(Puzzle *puzzle, unsigned int *i, unsigned int *j, unsigned int puzzleSize);
-
-/**
-  *This method gets an index of a cell in the board and makes it point to the previous unfixed cell
-  *
-  *Parameters:
-  *Puzzle *puzzle
-  *unsigned int *i - Pointer to the row
-  *unsigned int *j - Pointer to the column
-  *unsigned int puzzleSize - The size of the puzzle
-  *
-  *Preconditions:
-  *puzzle != 0
-  **i,*j < n*m
-  *puzzleSize = n*m
-  *
-  *Returns:
-  *1 iff an unfixed cell was found
-  */
-Bool precede(Puzzle *puzzle, unsigned int *i, unsigned int *j, unsigned int puzzleSize);
-
 #endif
\ No newline at end of file
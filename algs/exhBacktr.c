@@ -1,143 +1,504 @@
 #include "exhBacktr.h"
 #include <assert.h>
-#include "SudokuAlgs.h"
-#include "../utils/dataStructures/Stack.h"
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
 #include "../utils/MemAlloc.h"
 
-typedef struct {
+BacktrackEngine *createBacktrackEngine(unsigned int n, unsigned int m, CellOrder order) {
+	unsigned int dim = n * m;
+	BacktrackEngine *memAlloc(engine, BacktrackEngine);
 
-	/**
-	  *The row we are in
-	  */
-	unsigned int i;
+	assert(dim <= maxMaskDim);
+	engine->n = n;
+	engine->m = m;
+	engine->dim = dim;
+	engine->cellsNum = dim * dim;
+	engine->order = order;
+	engine->geometry = getGeometry(n, m);
+	engine->openNum = 0;
+	engine->marginals = 0;
+	engine->onSolution = 0;
+	engine->solutionArg = 0;
+	engine->onCheckpoint = 0;
+	engine->checkpointArg = 0;
+	memAllocN(engine->value, unsigned int, engine->cellsNum);
+	memAllocN(engine->rowMask, ValueMask, dim);
+	memAllocN(engine->colMask, ValueMask, dim);
+	memAllocN(engine->blockMask, ValueMask, dim);
+	memAllocN(engine->open, unsigned int, engine->cellsNum);
+	memAllocN(engine->frames, BacktrackFrame, engine->cellsNum);
 
-	/**
-	 *The column we are in
-	 */
-	unsigned int j;
+	return engine;
+}
 
-	/**
-	 *The puzzle right now
-	 */
-	Puzzle *puzzle;
-} PuzzleState;
+void destroyBacktrackEngine(BacktrackEngine *engine) {
+	memFree(engine->value);
+	memFree(engine->rowMask);
+	memFree(engine->colMask);
+	memFree(engine->blockMask);
+	memFree(engine->open);
+	memFree(engine->frames);
+	memFree(engine);
+}
 
 /**
-  *This method creates a new puzzle state.
-  *
-  *Returns:
-  *A pointer to a new dynamically allocated puzzle state.
-  */
-static PuzzleState *createPuzzleState(unsigned int i, unsigned int j, Puzzle *puzzle) {
-	PuzzleState *memAlloc(ps, PuzzleState);
-	ps->i = i;
-	ps->j = j;
-	ps->puzzle = puzzle;
-	return ps;
+ * This method assigns the value v to the empty cell c.
+ */
+static void assignCell(BacktrackEngine *engine, unsigned int c, unsigned int v) {
+	ValueMask bit = valueBit(v);
+	engine->value[c] = v;
+	engine->rowMask[engine->geometry->row[c]] |= bit;
+	engine->colMask[engine->geometry->col[c]] |= bit;
+	engine->blockMask[engine->geometry->block[c]] |= bit;
 }
 
 /**
-  *This method destroys a puzzle state.
-  *
-  *Parameters:
-  *PuzzleState *ps
-  *
-  *Preconditions:
-  *ps != 0
+ * This method reverts assignCell(engine, c, ...).
  */
-static void destroyPuzzleState(PuzzleState *ps) {
-	assert(ps != 0);
-	memFree(ps);
+static void clearCell(BacktrackEngine *engine, unsigned int c) {
+	ValueMask bit = valueBit(engine->value[c]);
+	engine->value[c] = 0;
+	engine->rowMask[engine->geometry->row[c]] &= ~bit;
+	engine->colMask[engine->geometry->col[c]] &= ~bit;
+	engine->blockMask[engine->geometry->block[c]] &= ~bit;
 }
 
 /**
-  *This method pushes the value of i, j and the address of puzzle to the stack s
-  *
-  *Parameters:
-  *Stack *s
-  *unsigned int i - The row
-  *unsigned int j - The column
-  *Puzzle *puzzle
-  *
-  *Preconditions:
-  *puzzle != 0, s != 0
-  *i,j < n*m
-  */
-static void pushPuzzleToStack(Stack *s, unsigned int i, unsigned int j, Puzzle *puzzle) {
-	PuzzleState *ps;
-	Puzzle *localP;
-
-	localP = copyPuzzle(puzzle);
-	ps = createPuzzleState(i, j, localP);
-	pushToStack(s, (void*) ps);
+ * This method returns the values that can be assigned to the empty cell c.
+ */
+static ValueMask cellCandidates(BacktrackEngine *engine, unsigned int c) {
+	return fullMask(engine->dim) & ~(engine->rowMask[engine->geometry->row[c]]
+		| engine->colMask[engine->geometry->col[c]] | engine->blockMask[engine->geometry->block[c]]);
+}
+
+void loadBacktrackEngine(BacktrackEngine *engine, Puzzle *p) {
+	unsigned int c;
+
+	assert(p->n == engine->n && p->m == engine->m);
+	for (c = 0; c < engine->dim; c++) {
+		engine->rowMask[c] = 0;
+		engine->colMask[c] = 0;
+		engine->blockMask[c] = 0;
+	}
+	engine->openNum = 0;
+	for (c = 0; c < engine->cellsNum; c++) {
+		engine->value[c] = 0;
+		if (p->cells[c]) {
+			assignCell(engine, c, p->cells[c]);
+		} else {
+			engine->open[engine->openNum++] = c;
+		}
+	}
 }
 
 /**
-  *This method pops the value of i, j and the address of puzzle from the stack s into the pointers i, j and puzzle
-  *
-  *Parameters:
-  *Stack *s
-  *unsigned int *i - The row
-  *unsigned int *j - The column
-  *Puzzle *puzzle
-  *
-  *Preconditions:
-  *s != 0
-  *i,j < n*m
-  */
-static void popPuzzleFromStack(Stack *s, unsigned int *i, unsigned int *j, Puzzle *puzzle) {
-	unsigned int a, b, c, size;
-	PuzzleState *ps = stackTop(s);
-
-	pop(s);
-	size = ps->puzzle->m*ps->puzzle->n;
-	*i = ps->i;
-	*j = ps->j;
-	puzzle->m = ps->puzzle->m;
-	puzzle->n = ps->puzzle->n;
-	puzzle->zeroCnt = ps->puzzle->zeroCnt;
-	for (a = 0; a < size; a++)
-		for (b = 0; b < size; b++)
-			for (c = 0; c <= 1; c++)
-				puzzle->board[a][b][c] = ps->puzzle->board[a][b][c];
-	destroyPuzzle(ps->puzzle);
-	destroyPuzzleState(ps);
-}
-
-int exhaustiveBacktracking(Puzzle *localP, unsigned int i, unsigned int j) {
-	unsigned int size = localP->m*localP->n, value, solutionCount = 0;
-	Stack *s = createStack();
-	unsigned int lastI = size - 1, lastJ = size - 1;
-	if (isCellFixed(localP, lastI, lastJ) == TRUE)
-		precede(localP, &lastI, &lastJ, size);
-
-	pushPuzzleToStack(s, i, j, localP);
-
-	while (stackTop(s) != 0) {
-		popPuzzleFromStack(s, &i, &j, localP);
-		if (i == lastI && j == lastJ) {
-			for (value = 1; value <= size; value++) {
-				if (isCellValueLegal(localP, i, j, value)) {
-					solutionCount++;
-				}
+ * This method sets the frame of the given depth: it chooses the next cell to assign
+ * among open[depth..openNum-1], moves it to open[depth] and computes its candidates.
+ */
+static void pushFrame(BacktrackEngine *engine, unsigned int depth) {
+	BacktrackFrame *frame = engine->frames + depth;
+	unsigned int k, c, best = depth, tmp;
+	ValueMask cand, bestCand;
+	unsigned int cnt, bestCnt;
+
+	bestCand = cellCandidates(engine, engine->open[depth]);
+	if (engine->order == cellOrderMRV) {
+		bestCnt = countValues(bestCand);
+		for (k = depth + 1; k < engine->openNum && bestCnt > 1; k++) {
+			c = engine->open[k];
+			cand = cellCandidates(engine, c);
+			cnt = countValues(cand);
+			if (cnt < bestCnt) {
+				best = k;
+				bestCand = cand;
+				bestCnt = cnt;
 			}
 		}
+		tmp = engine->open[depth];
+		engine->open[depth] = engine->open[best];
+		engine->open[best] = tmp;
+	}
+
+	frame->cell = engine->open[depth];
+	frame->remaining = bestCand;
+}
+
+void assumeBacktrackValue(BacktrackEngine *engine, unsigned int c, unsigned int v) {
+	unsigned int k;
+
+	assert(!engine->value[c] && (cellCandidates(engine, c) & valueBit(v)));
+	for (k = 0; engine->open[k] != c; k++) {
+	}
+	engine->open[k] = engine->open[--engine->openNum];
+	assignCell(engine, c, v);
+}
+
+/**
+ * This method reports the solution that assigns the value v to the last open cell c:
+ * it adds the solution to the marginals and passes it to the onSolution function.
+ */
+static void reportSolution(BacktrackEngine *engine, unsigned int c, unsigned int v) {
+	if (engine->marginals) {
+		engine->marginals[c * engine->dim + v - 1]++;
+	}
+	if (engine->onSolution) {
+		engine->value[c] = v;
+		engine->onSolution(engine->value, engine->solutionArg);
+		engine->value[c] = 0;
+	}
+}
+
+/**
+ * This method undoes the assignment of a frame, after its subtree has been searched.
+ * If the marginals are accumulated, the solutions of the subtree are added to the
+ * marginal of the assigned value.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * BacktrackFrame *frame
+ * unsigned long count - The number of the solutions that have been found so far
+ */
+static void releaseFrame(BacktrackEngine *engine, BacktrackFrame *frame, unsigned long count) {
+	if (engine->marginals) {
+		engine->marginals[frame->cell * engine->dim + engine->value[frame->cell] - 1] += count - frame->countMark;
+	}
+	clearCell(engine, frame->cell);
+}
 
-		else {
-			for (value = 1; value <= size; value++) {
-				setBoardValue(localP, i, j, 0);
-				if (isCellValueLegal(localP, i, j, value)) {
-					setBoardValue(localP, i, j, value);
-					proceed(localP, &i, &j, size);
-					pushPuzzleToStack(s, i, j, localP);
-					setBoardValue(localP, i, j, 0);
-					precede(localP, &i, &j, size);
+/**
+ * This method returns TRUE iff a checkpoint of the search is due, and if so it
+ * restarts the checkpoint interval. The clock is read once in 1024 calls.
+ */
+static Bool isCheckpointDue(BacktrackEngine *engine) {
+	Bool due = FALSE;
+	time_t now;
+
+	engine->nodes++;
+	if (engine->checkpointNodes && engine->nodes - engine->lastCheckpointNodes >= engine->checkpointNodes) {
+		due = TRUE;
+	}
+	if (engine->checkpointSeconds && !(engine->nodes & 1023)) {
+		now = time(0);
+		if (difftime(now, engine->lastCheckpointTime) >= engine->checkpointSeconds) {
+			due = TRUE;
+		}
+	}
+	if (due) {
+		engine->lastCheckpointNodes = engine->nodes;
+		engine->lastCheckpointTime = time(0);
+	}
+	return due;
+}
+
+/**
+ * This method runs the search on the loaded board, from a state in which
+ * frames[0..depth-1] are assigned and frames[depth] has been pushed.
+ * The branches that assign [maxDepth] cells are not searched: [onTask] is called
+ * for each of them instead. The search stops as soon as [limit] solutions have been found.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned int depth
+ * unsigned long count - The number of the solutions that have been found before this state
+ * unsigned int maxDepth
+ * unsigned long limit
+ * void (*onTask)(BacktrackEngine*, void*)
+ * void *arg - The argument of [onTask]
+ *
+ * Preconditions:
+ * engine->openNum ≥ 1
+ *
+ * Returns:
+ * The number of the solutions that have been found (at most [limit]), not including
+ * the solutions in the branches that were passed to [onTask]
+ */
+static unsigned long searchFrom(BacktrackEngine *engine, unsigned int depth, unsigned long count,
+		unsigned int maxDepth, unsigned long limit, void (*onTask)(BacktrackEngine *engine, void *arg), void *arg) {
+	unsigned int last = engine->openNum - 1;
+	BacktrackFrame *frame;
+	ValueMask bit;
+
+	while (TRUE) {
+		if (engine->onCheckpoint && isCheckpointDue(engine)) {
+			engine->onCheckpoint(engine, depth, count, engine->checkpointArg);
+		}
+
+		frame = engine->frames + depth;
+		if (!frame->remaining) { /* backtrack */
+			if (depth == 0) {
+				break;
+			}
+			releaseFrame(engine, engine->frames + --depth, count);
+			continue;
+		}
+
+		if (depth == last) { /* every candidate of the last cell completes a solution */
+			while (countValues(frame->remaining) > limit - count) {
+				frame->remaining &= frame->remaining - 1;
+			}
+			count += countValues(frame->remaining);
+			if (engine->marginals || engine->onSolution) {
+				for (; frame->remaining; frame->remaining &= frame->remaining - 1) {
+					reportSolution(engine, frame->cell, lowestValue(frame->remaining));
 				}
 			}
+			frame->remaining = 0;
+			if (count == limit) {
+				break;
+			}
+			continue;
+		}
+
+		bit = frame->remaining & (~frame->remaining + 1);
+		frame->remaining &= ~bit;
+		frame->countMark = count;
+		assignCell(engine, frame->cell, lowestValue(bit));
+
+		if (depth + 1 == maxDepth) {
+			onTask(engine, arg);
+			clearCell(engine, frame->cell);
+			continue;
+		}
+		pushFrame(engine, ++depth);
+	}
+
+	while (depth > 0) { /* the search may stop in the middle */
+		releaseFrame(engine, engine->frames + --depth, count);
+	}
+	return count;
+}
+
+/**
+ * This method runs the search on the loaded board from its root. See searchFrom.
+ */
+static unsigned long search(BacktrackEngine *engine, unsigned int maxDepth, unsigned long limit,
+		void (*onTask)(BacktrackEngine *engine, void *arg), void *arg) {
+	if (engine->openNum == 0) {
+		return 1;
+	}
+
+	pushFrame(engine, 0);
+	return searchFrom(engine, 0, 0, maxDepth, limit, onTask, arg);
+}
+
+unsigned long exhaustiveBacktracking(BacktrackEngine *engine) {
+	return search(engine, engine->openNum + 1, ULONG_MAX, 0, 0);
+}
+
+unsigned long boundedBacktracking(BacktrackEngine *engine, unsigned long limit) {
+	assert(limit >= 1);
+	return search(engine, engine->openNum + 1, limit, 0, 0);
+}
+
+unsigned long splitBacktracking(BacktrackEngine *engine, unsigned int depth,
+		void (*onTask)(BacktrackEngine *engine, void *arg), void *arg) {
+	assert(depth >= 1);
+	return search(engine, depth, ULONG_MAX, onTask, arg);
+}
+
+unsigned long marginalBacktracking(BacktrackEngine *engine, unsigned long limit, unsigned long *marginals) {
+	unsigned int c;
+	unsigned long count;
+
+	assert(limit >= 1);
+	for (c = 0; c < engine->cellsNum * engine->dim; c++) {
+		marginals[c] = 0;
+	}
+	engine->marginals = marginals;
+	count = search(engine, engine->openNum + 1, limit, 0, 0);
+	engine->marginals = 0;
+
+	for (c = 0; c < engine->cellsNum; c++) { /* the given cells */
+		if (engine->value[c]) {
+			marginals[c * engine->dim + engine->value[c] - 1] = count;
+		}
+	}
+	return count;
+}
+
+unsigned long enumerateBacktracking(BacktrackEngine *engine, unsigned long limit,
+		void (*onSolution)(const unsigned int *values, void *arg), void *arg) {
+	unsigned long count;
+
+	assert(limit >= 1);
+	if (engine->openNum == 0) { /* the loaded board is the single solution */
+		onSolution(engine->value, arg);
+		return 1;
+	}
+
+	engine->onSolution = onSolution;
+	engine->solutionArg = arg;
+	count = search(engine, engine->openNum + 1, limit, 0, 0);
+	engine->onSolution = 0;
+	engine->solutionArg = 0;
+	return count;
+}
+
+/**
+ * This method sets the checkpoints of the next search.
+ */
+static void setCheckpoints(BacktrackEngine *engine, unsigned long nodes, double seconds,
+		void (*onCheckpoint)(BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg), void *arg) {
+	engine->checkpointNodes = nodes;
+	engine->checkpointSeconds = seconds;
+	engine->onCheckpoint = onCheckpoint;
+	engine->checkpointArg = arg;
+	engine->nodes = 0;
+	engine->lastCheckpointNodes = 0;
+	engine->lastCheckpointTime = time(0);
+}
+
+unsigned long checkpointedBacktracking(BacktrackEngine *engine, unsigned long nodes, double seconds,
+		void (*onCheckpoint)(BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg), void *arg) {
+	unsigned long count;
+
+	setCheckpoints(engine, nodes, seconds, onCheckpoint, arg);
+	count = search(engine, engine->openNum + 1, ULONG_MAX, 0, 0);
+	engine->onCheckpoint = 0;
+	return count;
+}
+
+Bool saveBacktrackState(BacktrackEngine *engine, unsigned int depth, unsigned long count, FILE *fp) {
+	unsigned int k;
+	BacktrackFrame *frame;
+	int i;
+
+	i = fprintf(fp, "%s%u %u\n%lu %u %u\n", backtrackStateHeader, engine->n, engine->m, count, depth, engine->openNum);
+	for (k = 0; k < engine->openNum && i >= 0; k++) {
+		i = fprintf(fp, k ? " %u" : "%u", engine->open[k]);
+	}
+	if (i >= 0) {
+		i = fprintf(fp, "\n");
+	}
+	for (k = 0; k <= depth && i >= 0; k++) {
+		frame = engine->frames + k;
+		i = fprintf(fp, "%u %lx %lu\n", k < depth ? engine->value[frame->cell] : 0, frame->remaining, frame->countMark);
+	}
+	return i >= 0;
+}
+
+Bool loadBacktrackState(BacktrackEngine *engine, FILE *fp, unsigned int *depth, unsigned long *count) {
+	char header[sizeof(backtrackStateHeader)];
+	unsigned int n, m, openNum, k, c, v, *open;
+	BacktrackFrame *frame;
+
+	if (!fgets(header, sizeof(header), fp) || strcmp(header, backtrackStateHeader)
+		|| fscanf(fp, "%u %u %lu %u %u", &n, &m, count, depth, &openNum) != 5
+		|| n != engine->n || m != engine->m || openNum != engine->openNum || *depth >= openNum) {
+		return FALSE;
+	}
+
+	/*
+	 * The saved order of the open cells is accepted iff it is a permutation of the
+	 * empty cells of the loaded board. The cells that have been read are marked by a
+	 * non-zero value, which detects the duplicates.
+	 */
+	memAllocN(open, unsigned int, openNum);
+	for (c = 0; c < openNum; c++) {
+		if (fscanf(fp, "%u", open + c) != 1 || open[c] >= engine->cellsNum || engine->value[open[c]]) {
+			break;
+		}
+		engine->value[open[c]] = 1;
+	}
+	for (k = 0; k < c; k++) {
+		engine->value[open[k]] = 0;
+	}
+	if (c < openNum) {
+		memFree(open);
+		return FALSE;
+	}
+	memcpy(engine->open, open, openNum * sizeof(unsigned int));
+	memFree(open);
+
+	for (k = 0; k <= *depth; k++) {
+		frame = engine->frames + k;
+		frame->cell = engine->open[k];
+		if (fscanf(fp, "%u %lx %lu", &v, &frame->remaining, &frame->countMark) != 3
+			|| (frame->remaining & ~cellCandidates(engine, frame->cell))
+			|| (k < *depth && (!v || v > engine->dim || !(cellCandidates(engine, frame->cell) & valueBit(v))))) {
+			while (k > 0) {
+				clearCell(engine, engine->frames[--k].cell);
+			}
+			return FALSE;
+		}
+		if (k < *depth) {
+			assignCell(engine, frame->cell, v);
+		}
+	}
+
+	return TRUE;
+}
+
+unsigned long resumeBacktracking(BacktrackEngine *engine, unsigned int depth, unsigned long count,
+		unsigned long nodes, double seconds,
+		void (*onCheckpoint)(BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg), void *arg) {
+	setCheckpoints(engine, nodes, seconds, onCheckpoint, arg);
+	count = searchFrom(engine, depth, count, engine->openNum + 1, ULONG_MAX, 0, 0);
+	engine->onCheckpoint = 0;
+	return count;
+}
+
+/**
+ * This method makes a single probe of estimateBacktracking.
+ *
+ * Returns:
+ * The product of the numbers of the candidates along a random branch,
+ * or 0 if the branch reaches a dead end
+ */
+static double probe(BacktrackEngine *engine, Rng *rng) {
+	unsigned int depth, k, r;
+	double weight = 1;
+	ValueMask cand;
+
+	for (depth = 0; depth < engine->openNum; depth++) {
+		pushFrame(engine, depth);
+		cand = engine->frames[depth].remaining;
+		k = countValues(cand);
+		if (!k) {
+			weight = 0;
+			break;
+		}
+		weight *= k;
+		for (r = rngBelow(rng, k); r > 0; r--) { /* drop the r lowest candidates */
+			cand &= cand - 1;
+		}
+		assignCell(engine, engine->frames[depth].cell, lowestValue(cand));
+	}
+
+	while (depth > 0) {
+		clearCell(engine, engine->frames[--depth].cell);
+	}
+	return weight;
+}
+
+void estimateBacktracking(BacktrackEngine *engine, unsigned long samples, double seconds, Rng *rng,
+		CountEstimate *res) {
+	clock_t start = clock();
+	double weight, sum = 0, sumSquares = 0, mean, variance;
+	unsigned long s;
+
+	assert(samples >= 1);
+	for (s = 0; s < samples; s++) {
+		if (s > 0 && (double) (clock() - start) / CLOCKS_PER_SEC >= seconds) {
+			break;
 		}
+		weight = probe(engine, rng);
+		sum += weight;
+		sumSquares += weight * weight;
+	}
 
-		setBoardValue(localP, i, j, 0);
+	mean = sum / s;
+	variance = s > 1 ? (sumSquares - s * mean * mean) / (s - 1) : 0;
+	if (variance < 0) { /* rounding errors */
+		variance = 0;
 	}
-	destroyStack(s);
-	return solutionCount;
-}
\ No newline at end of file
+	res->estimate = mean;
+	res->low = mean - 1.96 * sqrt(variance / s);
+	res->high = mean + 1.96 * sqrt(variance / s);
+	if (res->low < 0) {
+		res->low = 0;
+	}
+	res->samples = s;
+}
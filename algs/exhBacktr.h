@@ -1,24 +1,441 @@
 #ifndef __ALGS_EXHBACKTR_H
 #define __ALGS_EXHBACKTR_H
 /**
- * This module implements the exhaustive backtracking algorithm.
+ * This module implements the exhaustive backtracking algorithm, which counts
+ * the solutions of a board.
+ * The search mutates a single board in place: every branching point is a frame
+ * of (cell, remaining candidates) on an explicit stack, and the frames double as
+ * the undo trail, since every frame assigns exactly one cell.
+ * Hence the memory is O(cells), and a node of the search takes O(1) time in the
+ * fixed order, or O(empty cells) in the MRV order, which pays off by pruning the
+ * search tree far more.
  */
 
+#include <stdio.h>
+#include <time.h>
+#include "../dataStructures/Geometry.h"
 #include "../dataStructures/Puzzle.h"
+#include "../utils/Rng.h"
+
+/**
+ * The first line of a saved search state.
+ */
+#define backtrackStateHeader "backtrack-state 1\n"
+
+/**
+ * This enum defines the order in which the search assigns the empty cells.
+ * cellOrderFixed - row by row
+ * cellOrderMRV - the cell with the minimum remaining values first.
+ *                A cell without candidates fails the branch immediately.
+ */
+typedef enum {
+	cellOrderFixed, cellOrderMRV
+} CellOrder;
+
+/**
+ * This struct defines an estimation of the number of the solutions of a board.
+ */
+typedef struct {
+
+	/**
+	 * The estimated number of the solutions.
+	 */
+	double estimate;
+
+	/**
+	 * The bounds of the 95% confidence interval of the estimation.
+	 */
+	double low;
+	double high;
+
+	/**
+	 * The number of the probes that the estimation is based on.
+	 */
+	unsigned long samples;
+} CountEstimate;
+
+/**
+ * This struct defines a branching point of the search.
+ */
+typedef struct {
+
+	/**
+	 * The index of the cell (x * (n*m) + y).
+	 */
+	unsigned int cell;
+
+	/**
+	 * The values that have not been tried yet.
+	 */
+	ValueMask remaining;
+
+	/**
+	 * The number of the solutions that had been found when the current value
+	 * of the cell was assigned.
+	 */
+	unsigned long countMark;
+} BacktrackFrame;
+
+/**
+ * This struct defines a solution counter for boards of a certain shape.
+ */
+typedef struct BacktrackEngine {
+
+	/**
+	 * The number of rows in each block.
+	 */
+	unsigned int n;
+
+	/**
+	 * The number of columns in each block.
+	 */
+	unsigned int m;
+
+	/**
+	 * n*m
+	 */
+	unsigned int dim;
+
+	/**
+	 * The number of the cells, dim^2.
+	 */
+	unsigned int cellsNum;
+
+	/**
+	 * The order of the search.
+	 */
+	CellOrder order;
+
+	/**
+	 * The value of each cell, 0 if it is empty.
+	 */
+	unsigned int *value;
+
+	/**
+	 * The row, the column and the block of each cell, shared by all the engines of this shape.
+	 */
+	const Geometry *geometry;
+
+	/**
+	 * The values that are placed in each row, column and block.
+	 */
+	ValueMask *rowMask;
+	ValueMask *colMask;
+	ValueMask *blockMask;
+
+	/**
+	 * The cells that were empty in the loaded board. During the search, open[0..depth-1]
+	 * are the cells that are assigned by the frames, in this order.
+	 */
+	unsigned int *open;
+	unsigned int openNum;
+
+	/**
+	 * The branching points of the search: frames[k] assigns the cell open[k].
+	 */
+	BacktrackFrame *frames;
+
+	/**
+	 * If it is not 0, the search adds to marginals[c * dim + v - 1] the number of the
+	 * solutions that assign the value v to the cell c.
+	 */
+	unsigned long *marginals;
+
+	/**
+	 * If it is not 0, the search calls onSolution(value, solutionArg) for every solution.
+	 */
+	void (*onSolution)(const unsigned int *values, void *arg);
+	void *solutionArg;
+
+	/**
+	 * If it is not 0, the search calls onCheckpoint(engine, depth, count, checkpointArg)
+	 * once in [checkpointNodes] nodes and once in [checkpointSeconds] seconds (a zero
+	 * interval is ignored), in a state that may be saved by saveBacktrackState.
+	 */
+	void (*onCheckpoint)(struct BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg);
+	void *checkpointArg;
+	unsigned long checkpointNodes;
+	double checkpointSeconds;
+
+	/**
+	 * The number of the nodes that the search has visited, and the state at the last checkpoint.
+	 */
+	unsigned long nodes;
+	unsigned long lastCheckpointNodes;
+	time_t lastCheckpointTime;
+} BacktrackEngine;
+
+/**
+ * This method creates a new solution counter for boards of n*m blocks.
+ *
+ * Parameters:
+ * unsigned int n - The number of rows in each block
+ * unsigned int m - The number of columns in each block
+ * CellOrder order - The order of the search
+ *
+ * Preconditions:
+ * n,m ≥ 1
+ * n*m ≤ maxMaskDim
+ *
+ * Returns:
+ * A pointer to a new dynamically allocated solution counter
+ */
+BacktrackEngine *createBacktrackEngine(unsigned int n, unsigned int m, CellOrder order);
+
+/**
+ * This method destroys a solution counter.
+ *
+ * Preconditions:
+ * engine != 0
+ */
+void destroyBacktrackEngine(BacktrackEngine *engine);
+
+/**
+ * This method loads the values of a puzzle into a solution counter.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * Puzzle *p
+ *
+ * Preconditions:
+ * engine, p != 0
+ * p->n == engine->n ∧ p->m == engine->m
+ * isPuzzleLegal(p)
+ */
+void loadBacktrackEngine(BacktrackEngine *engine, Puzzle *p);
 
 /**
   * This method implements the exhaustive backtracking algorithm
   * used in the calcSolutionsNum function in the SudokuAlgs module.
   *
   * Parameters:
-  * Puzzle *p
-  * unsigned int i - The row
-  * unsigned int j - The column
+  * BacktrackEngine *engine
   *
   * Preconditions:
-  * p != 0
-  * i,j < p->n * p->m
+  * engine != 0
+  * A board has been loaded into [engine]
+  *
+  * Returns:
+  * The number of the solutions of the loaded board
+  *
+  * Postconditions:
+  * The engine is left with the loaded board
   */
-int exhaustiveBacktracking(Puzzle *p, unsigned int i, unsigned int j);
+unsigned long exhaustiveBacktracking(BacktrackEngine *engine);
+
+/**
+  * This method is exhaustiveBacktracking, except that the search stops as soon as
+  * [limit] solutions have been found.
+  *
+  * Parameters:
+  * BacktrackEngine *engine
+  * unsigned long limit
+  *
+  * Preconditions:
+  * engine != 0
+  * A board has been loaded into [engine]
+  * limit ≥ 1
+  *
+  * Returns:
+  * The number of the solutions of the loaded board, or [limit] if there are at least [limit] solutions
+  *
+  * Postconditions:
+  * The engine is left with the loaded board
+  */
+unsigned long boundedBacktracking(BacktrackEngine *engine, unsigned long limit);
+
+/**
+ * This method assigns a value to an empty cell of the loaded board, as if the
+ * cell was given in the loaded puzzle.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned int c - The index of the cell (x * (n*m) + y)
+ * unsigned int v - The value
+ *
+ * Preconditions:
+ * engine != 0
+ * The cell c is empty, and v is legal in it
+ */
+void assumeBacktrackValue(BacktrackEngine *engine, unsigned int c, unsigned int v);
+
+/**
+ * This method splits the search tree of the loaded board at a certain depth.
+ * For every branch that assigns [depth] empty cells, [onTask] is called while the
+ * engine holds the branch: the cells are engine->frames[0..depth-1].cell, and their
+ * values are in engine->value. The branches are not searched further.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned int depth - The depth of the split
+ * void (*onTask)(BacktrackEngine*, void*) - The function that is called for every branch
+ * void *arg - The argument that is passed to [onTask]
+ *
+ * Preconditions:
+ * engine != 0
+ * A board has been loaded into [engine]
+ * depth ≥ 1
+ *
+ * Returns:
+ * The number of the solutions that assign less than [depth] empty cells
+ * (hence they are not passed to [onTask])
+ *
+ * Postconditions:
+ * The engine is left with the loaded board
+ */
+unsigned long splitBacktracking(BacktrackEngine *engine, unsigned int depth,
+		void (*onTask)(BacktrackEngine *engine, void *arg), void *arg);
+
+/**
+ * This method counts the solutions of the loaded board, like boundedBacktracking,
+ * and computes in the same pass the marginals of the solutions: the number of the
+ * solutions that assign every value to every cell. A cell is forced (a backbone cell)
+ * iff a single value of it has a non-zero marginal.
+ * The marginals of a subtree are added when the search leaves it, so the pass
+ * takes O(1) per node on top of the counting.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned long limit - The search stops as soon as [limit] solutions have been found,
+ *                       and the marginals are computed over these solutions
+ * unsigned long *marginals - The number of the solutions that assign the value v to the cell
+ *                            (x,y) would be stored in marginals[(x * dim + y) * dim + v - 1]
+ *
+ * Preconditions:
+ * engine != 0
+ * A board has been loaded into [engine]
+ * limit ≥ 1
+ * [marginals] is an array of size dim^3
+ *
+ * Returns:
+ * The number of the solutions that have been counted, at most [limit]
+ *
+ * Postconditions:
+ * The engine is left with the loaded board
+ */
+unsigned long marginalBacktracking(BacktrackEngine *engine, unsigned long limit, unsigned long *marginals);
+
+/**
+ * This method enumerates the solutions of the loaded board: [onSolution] is called
+ * for every solution, with the values of the cells (row by row) in a buffer of the
+ * engine that is reused by the next solutions. Hence the memory does not depend on
+ * the number of the solutions.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned long limit - The enumeration stops after [limit] solutions
+ * void (*onSolution)(const unsigned int*, void*) - The function that is called for every solution.
+ *                                                 It should not keep the buffer.
+ * void *arg - The argument that is passed to [onSolution]
+ *
+ * Preconditions:
+ * engine, onSolution != 0
+ * A board has been loaded into [engine]
+ * limit ≥ 1
+ *
+ * Returns:
+ * The number of the solutions that have been enumerated, at most [limit]
+ *
+ * Postconditions:
+ * The engine is left with the loaded board
+ */
+unsigned long enumerateBacktracking(BacktrackEngine *engine, unsigned long limit,
+		void (*onSolution)(const unsigned int *values, void *arg), void *arg);
+
+/**
+ * This method estimates the number of the solutions of the loaded board by Knuth's
+ * random probing: every probe descends from the root along a single random branch
+ * (in the order of the engine), and the product of the numbers of the candidates on
+ * the way is an unbiased estimation of the number of the solutions (0 if the probe
+ * reaches a dead end). The probes are averaged, and the confidence interval is derived
+ * from their sample variance.
+ * The random choices are drawn from [rng].
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned long samples - The maximal number of the probes
+ * double seconds - The maximal processor time of the estimation, in seconds
+ * Rng *rng
+ * CountEstimate *res - The estimation would be stored here
+ *
+ * Preconditions:
+ * engine, rng, res != 0
+ * A board has been loaded into [engine]
+ * samples ≥ 1
+ *
+ * Postconditions:
+ * At least one probe is made
+ * The engine is left with the loaded board
+ */
+void estimateBacktracking(BacktrackEngine *engine, unsigned long samples, double seconds, Rng *rng,
+		CountEstimate *res);
+
+/**
+ * This method counts the solutions of the loaded board like exhaustiveBacktracking,
+ * and calls [onCheckpoint] periodically (see BacktrackEngine.onCheckpoint).
+ * The state of the search at a checkpoint may be saved by saveBacktrackState,
+ * and the search may later be resumed from it by resumeBacktracking.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned long nodes - The checkpoint interval in nodes, 0 for none
+ * double seconds - The checkpoint interval in seconds, 0 for none
+ * void (*onCheckpoint)(BacktrackEngine*, unsigned int, unsigned long, void*) - The function that
+ *		is called at every checkpoint with the current depth and count of the search
+ * void *arg - The argument that is passed to [onCheckpoint]
+ *
+ * Preconditions:
+ * engine, onCheckpoint != 0
+ * A board has been loaded into [engine]
+ *
+ * Returns:
+ * The number of the solutions of the loaded board
+ */
+unsigned long checkpointedBacktracking(BacktrackEngine *engine, unsigned long nodes, double seconds,
+		void (*onCheckpoint)(BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg), void *arg);
+
+/**
+ * This method writes the state of the search in a text format: the dimensions, the
+ * order of the empty cells, the count so far and the frames of the stack.
+ * It may be called only from onCheckpoint.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * unsigned int depth, unsigned long count - As passed to onCheckpoint
+ * FILE *fp
+ *
+ * Returns:
+ * TRUE iff the operation succeeded.
+ */
+Bool saveBacktrackState(BacktrackEngine *engine, unsigned int depth, unsigned long count, FILE *fp);
+
+/**
+ * This method restores a state of the search that has been written by saveBacktrackState.
+ * The state is accepted only if it has been saved while counting the loaded board.
+ *
+ * Parameters:
+ * BacktrackEngine *engine
+ * FILE *fp
+ * unsigned int *depth, unsigned long *count - The depth and the count of the state would be stored here
+ *
+ * Preconditions:
+ * engine, fp, depth, count != 0
+ * A board has been loaded into [engine], and it has not been searched since
+ *
+ * Returns:
+ * TRUE iff the state has been restored. Otherwise, the engine is left with the loaded board.
+ */
+Bool loadBacktrackState(BacktrackEngine *engine, FILE *fp, unsigned int *depth, unsigned long *count);
+
+/**
+ * This method resumes a search from a state that has been restored by loadBacktrackState,
+ * like checkpointedBacktracking.
+ *
+ * Returns:
+ * The number of the solutions of the loaded board, including [count]
+ */
+unsigned long resumeBacktracking(BacktrackEngine *engine, unsigned int depth, unsigned long count,
+		unsigned long nodes, double seconds,
+		void (*onCheckpoint)(BacktrackEngine *engine, unsigned int depth, unsigned long count, void *arg), void *arg);
 
-#endif
\ No newline at end of file
+#endif
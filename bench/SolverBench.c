@@ -0,0 +1,173 @@
+/**
+ * This is a benchmark of the solvers of a puzzle. It reads puzzle files, solves every
+ * puzzle repeatedly by the constraint propagation solver (see CPSolver), and prints the
+ * time of a solve with the nodes and the backtracks of the search. It times the exact
+ * cover solver (see DLXSolver) on the same puzzles, and in a build with Gurobi the ILP
+ * solver (see ILPSolver) as well; every solver has to agree with the CP solver on
+ * whether a puzzle is solvable.
+ * With --count it also counts the solutions of every puzzle by the exhaustive backtracking
+ * in the fixed and in the MRV cell orders (see CellOrder).
+ * Build and run it by "make bench && ./solver-bench [--count] FILE...".
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../IO.h"
+#include "../algs/CPSolver.h"
+#include "../algs/DLXSolver.h"
+#include "../algs/SudokuAlgs.h"
+#include "../algs/exhBacktr.h"
+
+#ifdef USE_GUROBI
+#include "../algs/ILPSolver.h"
+#endif
+
+/**
+ * Every solver is timed over repeated solves for at least this many seconds.
+ */
+#define minBenchSeconds 0.5
+
+/**
+ * This method times a solver on a puzzle, and prints the time of a single solve.
+ *
+ * Parameters:
+ * const char *name - The name of the solver
+ * Bool (*solve)(Puzzle*, void*) - The solver, which gets a clone of [p]
+ * void *arg - The argument that is passed to [solve]
+ *
+ * Returns:
+ * TRUE iff the puzzle has been solved
+ */
+static Bool benchSolver(const char *name, Bool (*solve)(Puzzle*, void*), void *arg, Puzzle *p) {
+	unsigned long solves = 0;
+	clock_t start = clock();
+	double seconds;
+	Puzzle *clone;
+	Bool solved;
+
+	do {
+		clone = clonePuzzle(p);
+		solved = solve(clone, arg);
+		destroyPuzzle(clone);
+		solves++;
+		seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+	} while (seconds < minBenchSeconds);
+
+	printf("  %-3s %-10s %12.3f ms/solve", name, solved ? "solved" : "unsolvable", seconds * 1e3 / solves);
+	return solved;
+}
+
+static Bool solveCP(Puzzle *p, void *stats) {
+	return CPSolver(p, (CPStats*) stats);
+}
+
+static Bool solveDLX(Puzzle *p, void *arg) {
+	if (arg) { /* no argument */
+	}
+	return DLXSolver(p);
+}
+
+#ifdef USE_GUROBI
+static Bool solveILP(Puzzle *p, void *arg) {
+	if (arg) { /* no argument */
+	}
+	return ILPSolver(p);
+}
+#endif
+
+/**
+ * This method times the exhaustive count of the solutions of a puzzle in a cell order,
+ * and prints the time of a single count.
+ *
+ * Returns:
+ * The number of the solutions
+ */
+static unsigned long benchCount(const char *name, CellOrder order, Puzzle *p) {
+	unsigned long count, counts = 0;
+	clock_t start = clock();
+	double seconds;
+	BacktrackEngine *engine = createBacktrackEngine(p->n, p->m, order);
+
+	do {
+		loadBacktrackEngine(engine, p);
+		count = exhaustiveBacktracking(engine);
+		counts++;
+		seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+	} while (seconds < minBenchSeconds);
+
+	printf("  %-5s %12lu solutions %12.3f ms/count\n", name, count, seconds * 1e3 / counts);
+	destroyBacktrackEngine(engine);
+	return count;
+}
+
+/**
+ * This method benchmarks the solvers on the puzzle of a file.
+ *
+ * Parameters:
+ * char *path
+ * Bool count - Whether the solutions are counted in both cell orders
+ *
+ * Returns:
+ * FALSE iff the file is not a legal puzzle, or the solvers disagree
+ */
+static Bool benchFile(char *path, Bool count) {
+	Puzzle *p = readPuzzleFromFS(path, FALSE);
+	unsigned int c, emptyNum = 0;
+	CPStats stats;
+	Bool solved, agree = TRUE;
+
+	if (!p) {
+		printf("Error: %s could not be read\n", path);
+		return FALSE;
+	}
+	if (!isPuzzleLegal(p)) {
+		printf("Error: %s contains erroneous values\n", path);
+		destroyPuzzle(p);
+		return FALSE;
+	}
+
+	for (c = 0; c < p->n * p->m * p->n * p->m; c++) {
+		emptyNum += !p->cells[c];
+	}
+	printf("%s (%ux%u, %u empty cells)\n", path, p->n * p->m, p->n * p->m, emptyNum);
+	solved = benchSolver("cp", solveCP, &stats, p);
+	printf("  %10lu nodes %10lu backtracks\n", stats.nodes, stats.backtracks);
+	agree = benchSolver("dlx", solveDLX, 0, p) == solved;
+	printf("\n");
+#ifdef USE_GUROBI
+	agree = benchSolver("ilp", solveILP, 0, p) == solved && agree;
+	printf("\n");
+#endif
+	if (count && p->n * p->m <= maxMaskDim) {
+		agree = benchCount("fixed", cellOrderFixed, p) == benchCount("mrv", cellOrderMRV, p) && agree;
+	}
+
+	destroyPuzzle(p);
+	return agree;
+}
+
+int main(int argc, char *argv[]) {
+	int i = 1;
+	Bool count = FALSE, ok = TRUE;
+
+	if (argc > 1 && !strcmp(argv[1], "--count")) {
+		count = TRUE;
+		i++;
+	}
+	if (i == argc) {
+		printf("Usage: %s [--count] FILE...\n", argv[0]);
+		return 1;
+	}
+	for (; i < argc; i++) {
+		ok = benchFile(argv[i], count) && ok;
+	}
+
+	if (!ok) {
+		printf("Error: some puzzles were not benchmarked, or the solvers or the counts disagree\n");
+		return 1;
+	}
+	return 0;
+}
+
+#undef minBenchSeconds
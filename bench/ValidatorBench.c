@@ -0,0 +1,133 @@
+/**
+ * This is a microbenchmark of the grid validation kernels (see GridValidator).
+ * It builds a corpus of random grids of 9x9, 16x16 and 25x25 cells, about half of
+ * their cells empty and a quarter of them with a duplicate value, checks that all the
+ * supported kernels agree, and prints the throughput of every kernel in boards per second.
+ * Build and run it by "make bench && ./validator-bench".
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../algs/GridBank.h"
+#include "../algs/GridValidator.h"
+#include "../utils/MemAlloc.h"
+#include "../utils/Rng.h"
+
+/**
+ * The size of the corpus of every board size, in bytes.
+ */
+#define corpusBytes (1UL << 24)
+
+/**
+ * Every kernel is timed over repeated passes on the corpus for at least this many seconds.
+ */
+#define minBenchSeconds 0.5
+
+#define kernelsNum 3
+
+static const char *kernelNames[kernelsNum] = { "scalar", "sse2", "avx2" };
+
+/**
+ * This method fills [grids] with random grids of n*m blocks. About half of the cells are
+ * emptied, and every 4th grid gets a value of its row duplicated.
+ */
+static void fillCorpus(unsigned int n, unsigned int m, unsigned int *grids, unsigned long gridsNum, Rng *rng) {
+	unsigned int c, x, y1, y2, dim = n * m, cellsNum = dim * dim;
+	unsigned int *values, *scratch;
+	unsigned long g;
+
+	memAllocN(scratch, unsigned int, transformScratchLen(n, m));
+	for (g = 0; g < gridsNum; g++) {
+		values = grids + g * cellsNum;
+		fillPatternGrid(n, m, values);
+		transformGrid(n, m, values, scratch, rng);
+
+		x = rngBelow(rng, dim);
+		y1 = rngBelow(rng, dim);
+		y2 = (y1 + 1 + rngBelow(rng, dim - 1)) % dim;
+		if (g % 4 == 3) {
+			values[x * dim + y2] = values[x * dim + y1];
+		}
+		for (c = 0; c < cellsNum; c++) {
+			if (c != x * dim + y1 && c != x * dim + y2 && rngBelow(rng, 2)) {
+				values[c] = 0;
+			}
+		}
+	}
+	memFree(scratch);
+}
+
+/**
+ * This method benchmarks the supported kernels on boards of n*m blocks.
+ *
+ * Returns:
+ * FALSE iff the kernels disagree
+ */
+static Bool benchBoards(unsigned int n, unsigned int m, Rng *rng) {
+	unsigned int k, dim = n * m, cellsNum = dim * dim;
+	unsigned long g, passes, legalNum, expected = 0, gridsNum = corpusBytes / (cellsNum * sizeof(unsigned int));
+	unsigned int *grids;
+	Bool *legal, *reference;
+	clock_t start;
+	double seconds;
+	Bool agree = TRUE;
+
+	memAllocN(grids, unsigned int, gridsNum * cellsNum);
+	memAllocN(legal, Bool, gridsNum);
+	memAllocN(reference, Bool, gridsNum);
+	fillCorpus(n, m, grids, gridsNum, rng);
+
+	for (k = 0; k < kernelsNum; k++) {
+		if (!isValidatorKernelSupported((ValidatorKernel) k)) {
+			continue;
+		}
+
+		legalNum = validateGridsWith((ValidatorKernel) k, n, m, grids, gridsNum, legal);
+		if (k == validatorScalar) {
+			memcpy(reference, legal, gridsNum * sizeof(Bool));
+			expected = legalNum;
+		}
+		for (g = 0; g < gridsNum; g++) {
+			agree = agree && legal[g] == reference[g];
+		}
+
+		start = clock();
+		passes = 0;
+		do {
+			legalNum = validateGridsWith((ValidatorKernel) k, n, m, grids, gridsNum, 0);
+			passes++;
+			seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+		} while (seconds < minBenchSeconds);
+
+		printf("%2ux%-2u %-6s %12.0f boards/s %8.1f MB/s  %lu of %lu legal\n", dim, dim, kernelNames[k],
+				passes * gridsNum / seconds, passes * gridsNum * cellsNum * sizeof(unsigned int) / seconds / 1e6,
+				legalNum, gridsNum);
+		agree = agree && legalNum == expected;
+	}
+
+	memFree(grids);
+	memFree(legal);
+	memFree(reference);
+	return agree;
+}
+
+int main() {
+	Rng rng;
+	Bool agree;
+
+	seedRng(&rng, 1);
+	agree = benchBoards(3, 3, &rng);
+	agree = benchBoards(4, 4, &rng) && agree;
+	agree = benchBoards(5, 5, &rng) && agree;
+
+	if (!agree) {
+		printf("Error: the kernels disagree\n");
+		return 1;
+	}
+	return 0;
+}
+
+#undef corpusBytes
+#undef minBenchSeconds
+#undef kernelsNum
@@ -0,0 +1,104 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "Geometry.h"
+#include <pthread.h>
+#include "../utils/MemAlloc.h"
+
+/**
+ * This struct defines an element of the list of the built geometries.
+ */
+typedef struct GeometryElem {
+	Geometry geometry;
+	struct GeometryElem *next;
+} GeometryElem;
+
+/**
+ * The geometries that have been built, and the lock of the list.
+ */
+static GeometryElem *geometries = 0;
+static pthread_mutex_t geometriesLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * This method builds the geometry of the boards of n*m blocks.
+ */
+static void buildGeometry(Geometry *geometry, unsigned int n, unsigned int m) {
+	unsigned int dim = n * m, x, y, i, j, k, b;
+	unsigned int *peer;
+
+	geometry->n = n;
+	geometry->m = m;
+	geometry->dim = dim;
+	geometry->cellsNum = dim * dim;
+	geometry->peersNum = 2 * (dim - 1) + (n - 1) * (m - 1);
+	memAllocN(geometry->row, unsigned int, geometry->cellsNum);
+	memAllocN(geometry->col, unsigned int, geometry->cellsNum);
+	memAllocN(geometry->block, unsigned int, geometry->cellsNum);
+	memAllocN(geometry->units, unsigned int, 3 * geometry->cellsNum);
+	memAllocN(geometry->peers, unsigned int, geometry->cellsNum * geometry->peersNum + 1);
+
+	for (x = 0; x < dim; x++) {
+		for (y = 0; y < dim; y++) {
+			b = (x / n) * n + y / m;
+			geometry->row[x * dim + y] = x;
+			geometry->col[x * dim + y] = y;
+			geometry->block[x * dim + y] = b;
+			geometry->units[x * dim + y] = x * dim + y;
+			geometry->units[(dim + y) * dim + x] = x * dim + y;
+			geometry->units[(2 * dim + b) * dim + (x % n) * m + y % m] = x * dim + y;
+
+			peer = geometry->peers + (x * dim + y) * geometry->peersNum;
+			for (k = 0; k < dim; k++) {
+				if (k != y) {
+					*peer++ = x * dim + k;
+				}
+				if (k != x) {
+					*peer++ = k * dim + y;
+				}
+			}
+			for (i = x / n * n; i < x / n * n + n; i++) {
+				for (j = y / m * m; j < y / m * m + m; j++) {
+					if (i != x && j != y) {
+						*peer++ = i * dim + j;
+					}
+				}
+			}
+		}
+	}
+}
+
+const Geometry *getGeometry(unsigned int n, unsigned int m) {
+	GeometryElem *elem;
+
+	pthread_mutex_lock(&geometriesLock);
+	for (elem = geometries; elem; elem = elem->next) {
+		if (elem->geometry.n == n && elem->geometry.m == m) {
+			break;
+		}
+	}
+	if (!elem) {
+		memAlloc(elem, GeometryElem);
+		buildGeometry(&elem->geometry, n, m);
+		elem->next = geometries;
+		geometries = elem;
+	}
+	pthread_mutex_unlock(&geometriesLock);
+
+	return &elem->geometry;
+}
+
+void freeGeometries() {
+	GeometryElem *elem;
+
+	pthread_mutex_lock(&geometriesLock);
+	while (geometries) {
+		elem = geometries;
+		geometries = elem->next;
+		memFree(elem->geometry.row);
+		memFree(elem->geometry.col);
+		memFree(elem->geometry.block);
+		memFree(elem->geometry.units);
+		memFree(elem->geometry.peers);
+		memFree(elem);
+	}
+	pthread_mutex_unlock(&geometriesLock);
+}
@@ -0,0 +1,78 @@
+#ifndef __DATASTRUCTURES_GEOMETRY_H
+#define __DATASTRUCTURES_GEOMETRY_H
+/**
+ * This module defines the geometry of the boards of n*m blocks: the units (rows, columns
+ * and blocks) of every cell, the cells of every unit and the peers of every cell.
+ * A geometry is built once per block shape and is never changed, so all the engines and
+ * threads that work on boards of that shape share it instead of redoing the index math.
+ */
+
+/**
+ * This struct defines the geometry of the boards of n*m blocks.
+ * The cell (x,y) is the cell x * (n*m) + y, and the blocks are numbered row by row
+ * (see getBlockIndex).
+ */
+typedef struct {
+	unsigned int n;
+	unsigned int m;
+
+	/**
+	 * n*m
+	 */
+	unsigned int dim;
+
+	/**
+	 * The number of the cells, dim^2.
+	 */
+	unsigned int cellsNum;
+
+	/**
+	 * The row, the column and the block of each cell.
+	 */
+	unsigned int *row;
+	unsigned int *col;
+	unsigned int *block;
+
+	/**
+	 * The cells of each unit: the rows, then the columns, then the blocks, each in
+	 * row by row order. The cells of the unit u are units[u * dim], ..., units[(u + 1) * dim - 1].
+	 */
+	unsigned int *units;
+
+	/**
+	 * The number of the peers of each cell: the other cells of its row, column and block.
+	 */
+	unsigned int peersNum;
+
+	/**
+	 * The peers of each cell: the peers of the cell c are
+	 * peers[c * peersNum], ..., peers[(c + 1) * peersNum - 1].
+	 */
+	unsigned int *peers;
+} Geometry;
+
+/**
+ * This method returns the geometry of the boards of n*m blocks. It is built on the
+ * first call for n*m, and the following calls return the same geometry.
+ * It is thread-safe.
+ *
+ * Parameters:
+ * unsigned int n, unsigned int m - The dimensions of the blocks
+ *
+ * Preconditions:
+ * n,m ≥ 1
+ *
+ * Returns:
+ * The geometry, which is valid until freeGeometries is called
+ */
+const Geometry *getGeometry(unsigned int n, unsigned int m);
+
+/**
+ * This method frees all the geometries that have been built by getGeometry.
+ *
+ * Preconditions:
+ * None of them is in use
+ */
+void freeGeometries();
+
+#endif
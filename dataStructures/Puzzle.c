@@ -1,112 +1,346 @@
 #include "Puzzle.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include "../utils/MemAlloc.h"
 #include "../MainAux.h"
 #include "../algs/SudokuAlgs.h"
 
 /**
- * This method dynamically allocates a n*n*2 zeros tensor.
+ * This method lays out the arrays of a puzzle inside its memory block.
+ * If [puzzle] != 0, its pointers are set to point at their arrays.
+ *
+ * Parameters:
+ * Puzzle *puzzle - A puzzle, or 0 in order to compute the size only
+ * unsigned int n - The number of rows in each block
+ * unsigned int m - The number of columns in each block
+ *
+ * Returns:
+ * The size in bytes of the memory block of a n*m puzzle
  */
-static unsigned int ***allocateTensor(unsigned int n) {
-	unsigned int i, j;
-	unsigned int ***memAllocN(tensor, unsigned int**, n);
+static size_t layoutPuzzle(Puzzle *puzzle, unsigned int n, unsigned int m) {
+#define placeArray(field, type, count) \
+	size = (size + sizeof(type) - 1) / sizeof(type) * sizeof(type); \
+	if (puzzle) { puzzle->field = (type*) ((char*) puzzle + size); } \
+	size += (count) * sizeof(type)
 
-	for (i = 0; i < n; i++) {
-		memAllocN(tensor[i], unsigned int*, n);
+	unsigned int dim = n * m, cellsNum = dim * dim;
+	unsigned int masksNum = dim * bitsetWords(dim);
+	size_t size = sizeof(Puzzle);
 
-		for (j = 0; j < n; j++) {
-			memAllocN(tensor[i][j], unsigned int, 2);
-		}
-	}
+	placeArray(rowMask, ValueMask, masksNum);
+	placeArray(colMask, ValueMask, masksNum);
+	placeArray(blockMask, ValueMask, masksNum);
+	placeArray(cells, unsigned int, cellsNum);
+	placeArray(rowCnt, unsigned int, cellsNum);
+	placeArray(colCnt, unsigned int, cellsNum);
+	placeArray(blockCnt, unsigned int, cellsNum);
+	placeArray(errCells, unsigned int, cellsNum);
+	placeArray(errPos, unsigned int, cellsNum);
+	placeArray(dupUnits, unsigned char, cellsNum);
+	placeArray(fixed, unsigned char, (cellsNum + 7) / 8);
 
-	return tensor;
-}
-
-/**
- * This method clones a n*n*2 tensor.
- */
-static unsigned int ***cloneTensor(unsigned int ***tensor, unsigned int n) {
-	unsigned int*** clone = allocateTensor(n);
-	unsigned int i, j;
-
-	for (i = 0; i < n; i++) {
-		for (j = 0; j < n; j++) {
-			clone[i][j][0] = tensor[i][j][0];
-			clone[i][j][1] = tensor[i][j][1];
-		}
-	}
-
-	return clone;
-}
-
-/**
- * This method frees a n*n*2 tensor.
- */
-static void freeTensor(unsigned int ***tensor, unsigned int n) {
-	unsigned int i, j;
-	for (i = 0; i < n; i++) {
-		for (j = 0; j < n; j++) {
-			memFree(tensor[i][j]);
-		}
-		memFree(tensor[i]);
-	}
-	memFree(tensor);
+	return size;
+#undef placeArray
 }
 
 Puzzle *createPuzzle(unsigned int n, unsigned int m) {
-	unsigned int*** board = allocateTensor(n * m);
-	Puzzle *memAlloc(res, Puzzle);
+	size_t size = layoutPuzzle(0, n, m);
+	char *block;
+	Puzzle *res;
+	memAllocN(block, char, size);
+	res = (Puzzle*) block;
 	res->n = n;
 	res->m = m;
-	res->board = board;
+	res->size = size;
 	res->zeroCnt = n * m*n*m;
+	res->maskWords = bitsetWords(n * m);
+	layoutPuzzle(res, n, m);
 	return res;
 }
 
 void destroyPuzzle(Puzzle *puzzle) {
-	freeTensor(puzzle->board, puzzle->n * puzzle->m);
 	memFree(puzzle);
 }
 
 Puzzle *clonePuzzle(Puzzle *puzzle) {
-	Puzzle *memAlloc(res, Puzzle);
-	res->n = puzzle->n;
-	res->m = puzzle->m;
-	res->board = cloneTensor(puzzle->board, puzzle->n * puzzle->m);
-	res->zeroCnt = puzzle->zeroCnt;
+	Puzzle *memAllocSized(res, Puzzle, puzzle->size);
+	memcpy(res, puzzle, puzzle->size);
+	layoutPuzzle(res, res->n, res->m);
 	return res;
 }
 
+uint64_t zobristKey(unsigned int i, unsigned int v, Bool f) {
+	uint64_t z;
+	if (!v && !f) {
+		return 0;
+	}
+	/* splitmix64 of the cell state */
+	z = (((uint64_t) i) << 32 | ((uint64_t) v) << 1 | (uint64_t) f) + UINT64_C(0x9E3779B97F4A7C15);
+	z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+	return z ^ (z >> 31);
+}
+
+uint64_t getPuzzleHash(Puzzle *puzzle) {
+#ifdef DEBUG_CROSSCHECK
+	unsigned int i, dim = puzzle->n * puzzle->m;
+	uint64_t hash = 0;
+	for (i = 0; i < dim * dim; i++) {
+		hash ^= zobristKey(i, puzzle->cells[i], isCellFixed(puzzle, i / dim, i % dim));
+	}
+	assert(hash == puzzle->hash);
+#endif
+	return puzzle->hash;
+}
+
 Bool isCellFixed(Puzzle *puzzle, unsigned int x, unsigned int y) {
+	unsigned int i = x * puzzle->n*puzzle->m + y;
 	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m);
-	return ((puzzle->board)[x][y][1]);
+	return (puzzle->fixed[i / 8] >> (i % 8)) & 1;
 }
 
-void fixCell(Puzzle *puzzle, unsigned int x, unsigned int y) {
+/**
+ * This method sets the fixed flag of the cell (x,y) and updates the hash.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int x - The row
+ * unsigned int y - The column
+ * Bool f - Whether the cell should be fixed
+ */
+static void setCellFixed(Puzzle *puzzle, unsigned int x, unsigned int y, Bool f) {
+	unsigned int i = x * puzzle->n*puzzle->m + y;
 	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m);
-	(puzzle->board)[x][y][1] = 1;
+	if (isCellFixed(puzzle, x, y) == f) {
+		return;
+	}
+	puzzle->hash ^= zobristKey(i, puzzle->cells[i], !f) ^ zobristKey(i, puzzle->cells[i], f);
+	if (f) {
+		puzzle->fixed[i / 8] |= (unsigned char) (1 << (i % 8));
+	} else {
+		puzzle->fixed[i / 8] &= (unsigned char) ~(1 << (i % 8));
+	}
+}
+
+void fixCell(Puzzle *puzzle, unsigned int x, unsigned int y) {
+	setCellFixed(puzzle, x, y, TRUE);
 }
 
 void unFixCell(Puzzle *puzzle, unsigned int x, unsigned int y) {
-	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m);
-	(puzzle->board)[x][y][1] = 0;
+	setCellFixed(puzzle, x, y, FALSE);
 }
 
 unsigned int getBoardValue(Puzzle *puzzle, unsigned int x, unsigned int y) {
 	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m);
-	return (puzzle->board)[x][y][0];
+	return puzzle->cells[x * puzzle->n*puzzle->m + y];
+}
+
+unsigned int getBlockIndex(Puzzle *puzzle, unsigned int x, unsigned int y) {
+	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m);
+	return (x / puzzle->n) * puzzle->n + y / puzzle->m;
+}
+
+/**
+ * The kinds of the units (rows, columns and blocks) of the board.
+ */
+typedef enum {
+	unitRow, unitCol, unitBlock
+} UnitKind;
+
+/**
+ * This method returns the index (x * (n*m) + y) of the k-th cell of a unit.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * UnitKind kind - The kind of the unit
+ * unsigned int u - The index of the unit
+ * unsigned int k - The index of the cell inside the unit
+ *
+ * Preconditions:
+ * 0 ≤ u,k < n*m
+ */
+static unsigned int unitCell(Puzzle *puzzle, UnitKind kind, unsigned int u, unsigned int k) {
+	unsigned int dim = puzzle->n * puzzle->m;
+	switch (kind) {
+	case unitRow:
+		return u * dim + k;
+	case unitCol:
+		return k * dim + u;
+	default:
+		return ((u / puzzle->n) * puzzle->n + k / puzzle->m) * dim + (u % puzzle->n) * puzzle->m + k % puzzle->m;
+	}
+}
+
+/**
+ * This method returns the index of a cell, other than [self], that contains the value v
+ * in the given unit.
+ *
+ * Preconditions:
+ * Such a cell exists
+ */
+static unsigned int findValueInUnit(Puzzle *puzzle, UnitKind kind, unsigned int u, unsigned int v, unsigned int self) {
+	unsigned int k, c = self;
+	for (k = 0; k < puzzle->n * puzzle->m; k++) {
+		c = unitCell(puzzle, kind, u, k);
+		if (c != self && puzzle->cells[c] == v) {
+			break;
+		}
+	}
+	assert(c != self && puzzle->cells[c] == v);
+	return c;
+}
+
+/**
+ * This method updates the number of units in which the value of a cell is duplicated,
+ * and accordingly, the set of the erroneous cells.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int cell - The index of the cell
+ * Bool inc - TRUE iff the number should be incremented, otherwise it is decremented
+ */
+static void updateDupUnits(Puzzle *puzzle, unsigned int cell, Bool inc) {
+	unsigned int last;
+	if (inc) {
+		if (puzzle->dupUnits[cell]++ == 0) {
+			puzzle->errPos[cell] = puzzle->errCnt;
+			puzzle->errCells[puzzle->errCnt++] = cell;
+		}
+	} else {
+		assert(puzzle->dupUnits[cell] > 0);
+		if (--puzzle->dupUnits[cell] == 0) {
+			last = puzzle->errCells[--puzzle->errCnt];
+			puzzle->errCells[puzzle->errPos[cell]] = last;
+			puzzle->errPos[last] = puzzle->errPos[cell];
+		}
+	}
+}
+
+/**
+ * This method updates the occurrences counter, the mask, the conflicts counter and
+ * the erroneous cells of a unit of the cell [self], after the value v has been
+ * added to / removed from that cell.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * UnitKind kind - The kind of the unit
+ * unsigned int u - The index of the unit
+ * unsigned int v - The value
+ * unsigned int self - The index of the cell
+ * Bool add - TRUE iff v has been added
+ *
+ * Preconditions:
+ * 1 ≤ v ≤ n*m
+ * puzzle->cells[self] != v
+ */
+static void updateUnit(Puzzle *puzzle, UnitKind kind, unsigned int u, unsigned int v, unsigned int self, Bool add) {
+	unsigned int dim = puzzle->n * puzzle->m, c;
+	unsigned int *cnt = kind == unitRow ? puzzle->rowCnt : kind == unitCol ? puzzle->colCnt : puzzle->blockCnt;
+	ValueMask *masks = (kind == unitRow ? puzzle->rowMask : kind == unitCol ? puzzle->colMask : puzzle->blockMask)
+		+ u * puzzle->maskWords;
+
+	if (add) {
+		c = cnt[u * dim + v - 1]++;
+		puzzle->conflictCnt += c;
+		if (c == 0) {
+			addBitsetValue(masks, v);
+		}
+	} else {
+		c = --cnt[u * dim + v - 1];
+		puzzle->conflictCnt -= c;
+		if (c == 0) {
+			removeBitsetValue(masks, v);
+		}
+	}
+
+	/* c is the number of the other cells in the unit that contain v */
+	if (c == 1) {
+		updateDupUnits(puzzle, findValueInUnit(puzzle, kind, u, v, self), add);
+	}
+	if (c >= 1) {
+		updateDupUnits(puzzle, self, add);
+	}
+}
+
+/**
+ * This method updates the state of the units of the cell (x,y),
+ * after the value v has been added to / removed from that cell.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int x - The row
+ * unsigned int y - The column
+ * unsigned int v - The value
+ * Bool add - TRUE iff v has been added
+ *
+ * Preconditions:
+ * 1 ≤ v ≤ n*m
+ * getBoardValue(puzzle, x, y) != v
+ */
+static void updateUnits(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int v, Bool add) {
+	unsigned int self = x * puzzle->n * puzzle->m + y;
+	updateUnit(puzzle, unitRow, x, v, self, add);
+	updateUnit(puzzle, unitCol, y, v, self, add);
+	updateUnit(puzzle, unitBlock, getBlockIndex(puzzle, x, y), v, self, add);
 }
 
 void setBoardValue(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int v) {
+	unsigned int old;
+	Bool f;
 	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m && v <= puzzle->n*puzzle->m);
-	if (getBoardValue(puzzle, x, y) && !v) {
+	old = getBoardValue(puzzle, x, y);
+	if (old == v) {
+		return;
+	}
+	if (old && !v) {
 		puzzle->zeroCnt++;
-	} else if (!getBoardValue(puzzle, x, y) && v) {
+	} else if (!old && v) {
 		puzzle->zeroCnt--;
 	}
-	(puzzle->board)[x][y][0] = v;
+	if (old) {
+		updateUnits(puzzle, x, y, old, FALSE);
+		puzzle->cells[x * puzzle->n*puzzle->m + y] = 0;
+	}
+	if (v) {
+		updateUnits(puzzle, x, y, v, TRUE);
+	}
+	puzzle->cells[x * puzzle->n*puzzle->m + y] = v;
+	f = isCellFixed(puzzle, x, y);
+	puzzle->hash ^= zobristKey(x * puzzle->n*puzzle->m + y, old, f) ^ zobristKey(x * puzzle->n*puzzle->m + y, v, f);
+}
+
+Bool isCellErroneous(Puzzle *puzzle, unsigned int x, unsigned int y) {
+	assert(x < puzzle->n*puzzle->m && y < puzzle->n*puzzle->m);
+	return puzzle->dupUnits[x * puzzle->n*puzzle->m + y] != 0;
+}
+
+unsigned int getErroneousCellsNum(Puzzle *puzzle) {
+	return puzzle->errCnt;
+}
+
+void getErroneousCell(Puzzle *puzzle, unsigned int i, unsigned int *x, unsigned int *y) {
+	unsigned int dim = puzzle->n * puzzle->m;
+	assert(i < puzzle->errCnt);
+	*x = puzzle->errCells[i] / dim;
+	*y = puzzle->errCells[i] % dim;
+}
+
+ValueMask getCellCandidates(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int w) {
+	unsigned int dim = puzzle->n * puzzle->m, words = puzzle->maskWords;
+	unsigned int b = getBlockIndex(puzzle, x, y);
+	unsigned int v = getBoardValue(puzzle, x, y);
+	ValueMask res;
+
+	assert(w < words);
+	res = fullBitsetWord(dim, w)
+		& ~(puzzle->rowMask[x * words + w] | puzzle->colMask[y * words + w] | puzzle->blockMask[b * words + w]);
+	if (v && bitsetWord(v) == w && puzzle->rowCnt[x * dim + v - 1] == 1 && puzzle->colCnt[y * dim + v - 1] == 1
+		&& puzzle->blockCnt[b * dim + v - 1] == 1) { /* only (x,y) itself uses v */
+		res |= bitsetBit(v);
+	}
+	return res;
 }
 
 void applyActivitySingle(Puzzle *puzzle, Move *move) {
@@ -185,7 +419,10 @@ void printBoard(Puzzle *puzzle, Bool markErrorsFlag) {
 					if (isCellFixed(puzzle, x, y)) {
 						printf(".");
 					} else {
-						if (markErrorsFlag && !isCellLegal(puzzle, x, y)) {
+#ifdef DEBUG_CROSSCHECK
+						assert(isCellErroneous(puzzle, x, y) == !isCellLegal(puzzle, x, y));
+#endif
+						if (markErrorsFlag && isCellErroneous(puzzle, x, y)) {
 							printf("*");
 						} else {
 							printf(" ");
@@ -4,11 +4,17 @@
  * This module defines the Puzzle struct which represents a Sudoku board.
  */
 
+#include <stddef.h>
+#include <stdint.h>
+#include "../utils/Bitset.h"
 #include "../utils/Boolean.h"
 #include "Activity.h"
 
 /**
  * This struct represents a Sudoku board.
+ * A puzzle is allocated as a single memory block: the struct itself is
+ * followed by the arrays that its pointers point at. Therefore a puzzle
+ * may be cloned by a single memcpy.
  */
 typedef struct {
 
@@ -17,6 +23,19 @@ typedef struct {
 	 */
 	unsigned int zeroCnt;
 
+	/**
+	 * The number of conflicts in the board, i.e. the sum over all the rows, columns
+	 * and blocks of the number of pairs of cells in that unit that contain the same value.
+	 * The board is legal iff conflictCnt == 0.
+	 */
+	unsigned int conflictCnt;
+
+	/**
+	 * A Zobrist hash of the board: the XOR of zobristKey(i, v, f) over all the cells,
+	 * where i = x * (n*m) + y, v is the value of (x,y) and f is 1 iff it is fixed.
+	 */
+	uint64_t hash;
+
 	/**
 	 * The number of rows in each block.
 	 */
@@ -28,12 +47,67 @@ typedef struct {
 	unsigned int m;
 
 	/**
-	 * This is a (n*m) * (n*m) * 2 tensor.
-	 * each 2 cells represent a cell in the board - The first
-	 * cell is the value, the second may be 0 or 1, and is 1 iff
-	 * the cell is fixed.
+	 * The size in bytes of the memory block that holds the puzzle.
+	 */
+	size_t size;
+
+	/**
+	 * The values of the cells, row by row: the value of the cell (x,y)
+	 * is cells[x * (n*m) + y].
+	 */
+	unsigned int *cells;
+
+	/**
+	 * A bitmap of the fixed cells: the cell (x,y) is fixed iff the
+	 * bit (x * (n*m) + y) is on.
+	 */
+	unsigned char *fixed;
+
+	/**
+	 * The number of occurrences of each value in each row, column and block:
+	 * the number of occurrences of the value v (1 ≤ v ≤ n*m) in the row (column, block) u
+	 * is rowCnt[u * (n*m) + v - 1] (colCnt[...], blockCnt[...]).
+	 * The blocks are numbered row by row, see getBlockIndex.
 	 */
-	unsigned int ***board;
+	unsigned int *rowCnt;
+	unsigned int *colCnt;
+	unsigned int *blockCnt;
+
+	/**
+	 * The number of the words of the masks below, bitsetWords(n*m).
+	 */
+	unsigned int maskWords;
+
+	/**
+	 * The values that are used in each row, column and block: the set of the row u
+	 * (column u, block u) is the bitset of maskWords words at rowMask + u * maskWords
+	 * (colMask + ..., blockMask + ...), which contains v iff rowCnt[u * (n*m) + v - 1] > 0.
+	 */
+	ValueMask *rowMask;
+	ValueMask *colMask;
+	ValueMask *blockMask;
+
+	/**
+	 * For every cell, the number of its units (row, column, block) that contain
+	 * its value in another cell as well. A cell is erroneous iff this number is positive.
+	 */
+	unsigned char *dupUnits;
+
+	/**
+	 * The number of erroneous cells.
+	 */
+	unsigned int errCnt;
+
+	/**
+	 * The indices (x * (n*m) + y) of the erroneous cells, in no particular order.
+	 * Only the first errCnt elements are meaningful.
+	 */
+	unsigned int *errCells;
+
+	/**
+	 * For every erroneous cell, its position in errCells.
+	 */
+	unsigned int *errPos;
 } Puzzle;
 
 /**
@@ -152,6 +226,114 @@ unsigned int getBoardValue(Puzzle *puzzle, unsigned int x, unsigned int y);
  */
 void setBoardValue(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int v);
 
+/**
+ * This method returns the Zobrist key of a cell state.
+ * The keys are fixed, hence the hashes are comparable across puzzles and runs.
+ *
+ * Parameters:
+ * unsigned int i - The index of the cell (x * (n*m) + y)
+ * unsigned int v - The value of the cell
+ * Bool f - Whether the cell is fixed
+ *
+ * Returns:
+ * A pseudo random 64-bit key, 0 for an empty non-fixed cell
+ */
+uint64_t zobristKey(unsigned int i, unsigned int v, Bool f);
+
+/**
+ * This method returns the Zobrist hash of the board (values and fixed cells).
+ * The hash is maintained by setBoardValue, fixCell and unFixCell, hence it takes O(1).
+ *
+ * Preconditions:
+ * puzzle != 0
+ */
+uint64_t getPuzzleHash(Puzzle *puzzle);
+
+/**
+ * This method returns the index of the block that contains the cell (x,y).
+ * The blocks are numbered row by row.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int x - The row
+ * unsigned int y - The column
+ *
+ * Preconditions:
+ * puzzle != 0
+ * 0 ≤ x,y < n*m
+ *
+ * Returns:
+ * (x / n) * n + y / m
+ */
+unsigned int getBlockIndex(Puzzle *puzzle, unsigned int x, unsigned int y);
+
+/**
+ * This method returns true iff the cell (x,y) is erroneous, i.e. its value
+ * is contained in another cell in its row, column or block.
+ * The set of the erroneous cells is maintained by setBoardValue, hence it takes O(1).
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int x - The row
+ * unsigned int y - The column
+ *
+ * Preconditions:
+ * puzzle != 0
+ * 0 ≤ x,y < n*m
+ */
+Bool isCellErroneous(Puzzle *puzzle, unsigned int x, unsigned int y);
+
+/**
+ * This method returns the number of the erroneous cells in the board.
+ *
+ * Preconditions:
+ * puzzle != 0
+ */
+unsigned int getErroneousCellsNum(Puzzle *puzzle);
+
+/**
+ * This method retrieves the i-th erroneous cell in the board.
+ * The erroneous cells are listed in no particular order, and the order may
+ * change whenever the board is modified.
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int i - The index of the erroneous cell
+ * unsigned int *x - The row of the cell would be stored here
+ * unsigned int *y - The column of the cell would be stored here
+ *
+ * Preconditions:
+ * puzzle, x, y != 0
+ * i < getErroneousCellsNum(puzzle)
+ *
+ * Postconditions:
+ * isCellErroneous(puzzle, *x, *y)
+ */
+void getErroneousCell(Puzzle *puzzle, unsigned int i, unsigned int *x, unsigned int *y);
+
+/**
+ * This method returns the values that may be legally assigned to the cell (x,y),
+ * i.e. the values that are not used by any other cell in the row, the column
+ * or the block of (x,y). The value of (x,y) itself is ignored.
+ * The set is a bitset of maskWords words (see Bitset), and this method returns its word w,
+ * computed from the maintained masks in O(1).
+ *
+ * Parameters:
+ * Puzzle *puzzle
+ * unsigned int x - The row
+ * unsigned int y - The column
+ * unsigned int w - The index of the word
+ *
+ * Preconditions:
+ * puzzle != 0
+ * 0 ≤ x,y < n*m
+ * w < puzzle->maskWords
+ *
+ * Returns:
+ * The word w of the set of the legal values of the cell (x,y)
+ */
+ValueMask getCellCandidates(Puzzle *puzzle, unsigned int x, unsigned int y, unsigned int w);
+
 /**
  * This method applies a single move.
  *
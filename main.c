@@ -3,18 +3,16 @@
  */
 
 #include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
 #include "MainAux.h"
 #include "Strings.h"
 
 /**
- * The program uses time(0) as a seed for PRNG.
+ * With command line arguments, the program runs headless (see headlessMain).
  */
-int main() {
-	unsigned int seed;
-	seed = (unsigned int) time(0);
-	srand(seed);
+int main(int argc, char *argv[]) {
+	if (argc > 1) {
+		return headlessMain(argc, argv);
+	}
 
 	printf("%s\n", infoMsgBeginning);
 	mainLoop();
@@ -2,16 +2,18 @@
 #include "../IO.h"
 #include "../Shared.h"
 #include "../Strings.h"
+#include "../algs/GridBank.h"
 #include "../algs/SudokuAlgs.h"
 #include "../dataStructures/Activity.h"
 #include "../dataStructures/Puzzle.h"
 #include "../utils/MemAlloc.h"
 #include "../utils/Strings.h"
 #include "Parser.h"
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 
-SharedBundle bundle;
+extern SharedBundle bundle;
 
 #define returnGameMode(ret, mode) \
     ret.isFlag = 0;               \
@@ -27,6 +29,26 @@ SharedBundle bundle;
 						} \
 					}
 
+/**
+ * The default number of the probes of "estimate_solutions".
+ */
+#define defaultEstimateSamples 100000
+
+/**
+ * The processor time budget of "estimate_solutions", in seconds.
+ */
+#define estimateTimeBudget 1.0
+
+/**
+ * The default checkpoint interval of "count_resumable", in seconds.
+ */
+#define defaultCheckpointSeconds 10
+
+/**
+ * The default processor time budget of "generate_unique", in seconds.
+ */
+#define defaultGenerateUniqueSeconds 5
+
 #define printBoardReg printBoard(bundle.puzzle, bundle.markErrorsFlag || getCurrentGameMode() == gameModeEdit)
 
 /**
@@ -219,6 +241,44 @@ static ParserFeedback markErrorsOp(LinkedList* args) {
 #undef finish
 }
 
+/**
+ * The operation of the "threads" command.
+ */
+static ParserFeedback threadsOp(LinkedList* args) {
+	ParserFeedback ret;
+	int x;
+	LinkedListElem* elem = args->first;
+	const char *arg = elem->data;
+
+	x = isUInteger(arg);
+
+	if (x == -1) {
+		printf("%s\n", errMsgErroneousThreadsVal);
+	} else {
+		bundle.threadsNum = x;
+	}
+
+	returnGameMode(ret, getCurrentGameMode());
+}
+
+/**
+ * The operation of the "seed" command.
+ * It reseeds the generator of the random choices of the commands, so the
+ * commands that follow are reproducible.
+ */
+static ParserFeedback seedOp(LinkedList* args) {
+	ParserFeedback ret;
+	int x = isUInteger(args->first->data);
+
+	if (x == -1) {
+		printf("%s\n", errMsgErroneousSeedVal);
+	} else {
+		seedRng(&bundle.rng, (uint64_t) x);
+	}
+
+	returnGameMode(ret, getCurrentGameMode());
+}
+
 static ParserFeedback printBoardOp(LinkedList* args) {
 	ParserFeedback ret;
 
@@ -315,7 +375,7 @@ static ParserFeedback generateOp(LinkedList* args) {
 		if (y == 0) {
 			printBoardReg;
 		} else {
-			if (generatePuzzle(bundle.puzzle, (unsigned int) x, (unsigned int) y)) {
+			if (generatePuzzle(bundle.puzzle, (unsigned int) x, (unsigned int) y, &bundle.rng)) {
 				action = buildAction(bundle.puzzle);
 				addAction(bundle.activity, action);
 				printBoardReg;
@@ -328,6 +388,78 @@ static ParserFeedback generateOp(LinkedList* args) {
 	returnGameMode(ret, getCurrentGameMode());
 }
 
+/**
+ * The operation of the "build_bank" command.
+ * It writes a bank of [gridsNum] random solved grids of the dimensions of the current board,
+ * which "generate" then draws from.
+ */
+static ParserFeedback buildBankOp(LinkedList* args) {
+#define finish returnGameMode(ret, getCurrentGameMode())
+	ParserFeedback ret;
+	int gridsNum = isUInteger(args->first->data);
+	char path[maxInputLength];
+
+	if (gridsNum < 1) {
+		printf("%s\n", errMsgErroneousGridsVal);
+		finish;
+	}
+
+	sprintf(path, gridBankPathFormat, bundle.puzzle->n, bundle.puzzle->m);
+	if (buildGridBank(bundle.puzzle->n, bundle.puzzle->m, (unsigned int) gridsNum, &bundle.rng)) {
+		printf(infoMsgSavedToFS, path);
+	} else {
+		printf("%s\n", errMsgIOCreationModFailed);
+	}
+
+	finish;
+#undef finish
+}
+
+/**
+ * The operation of the "generate_unique" command.
+ * It generates a puzzle with a single solution and [y] clues, or as few clues as
+ * possible above [y] within the time budget (0 for a minimal puzzle).
+ */
+static ParserFeedback generateUniqueOp(LinkedList* args) {
+#define finish returnGameMode(ret, getCurrentGameMode())
+	ParserFeedback ret;
+	int y, seconds = defaultGenerateUniqueSeconds;
+	unsigned int clues, blankCount = countZeros(bundle.puzzle);
+	const char *arg = args->first->next->data;
+
+	y = isUInteger(args->first->data);
+	if (y == -1 || ((unsigned int) y) > blankCount) {
+		printf(errMsgNotInRange, blankCount);
+		finish;
+	}
+	if (arg) {
+		seconds = isUInteger(arg);
+		if (seconds < 1) {
+			printf("%s\n", errMsgErroneousSecondsVal);
+			finish;
+		}
+	}
+	if (!isEmpty(bundle.puzzle)) {
+		printf("%s\n", errMsgNonEmptyBoard);
+		finish;
+	}
+
+	clues = generateUniquePuzzle(bundle.puzzle, (unsigned int) y, seconds, &bundle.rng);
+	if (!clues) {
+		printf("%s\n", errMsgGenFailed);
+		finish;
+	}
+
+	addAction(bundle.activity, buildAction(bundle.puzzle));
+	printBoardReg;
+	if (clues > (unsigned int) y) {
+		printf(infoMsgUniqueClues, clues);
+	}
+
+	finish;
+#undef finish
+}
+
 /**
  * This method gets an element of a linked-list that wraps a Move,
  * and prints the details of the undo.
@@ -443,9 +575,16 @@ static ParserFeedback saveOp(LinkedList* args) {
 static ParserFeedback numSolutionsOp(LinkedList* args) {
 #define finish returnGameMode(ret, getCurrentGameMode())
 	ParserFeedback ret;
-	unsigned int solutionsNum;
-
-	if (args) {
+	uint64_t solutionsNum;
+	int limit = 0;
+	const char *arg = args->first->data;
+
+	if (arg) {
+		limit = isUInteger(arg);
+		if (limit < 1) {
+			printf("%s\n", errMsgErroneousLimitVal);
+			finish;
+		}
 	}
 
 	if (!isPuzzleLegal(bundle.puzzle)) {
@@ -453,11 +592,19 @@ static ParserFeedback numSolutionsOp(LinkedList* args) {
 		finish;
 	}
 
-	solutionsNum = calcSolutionsNum(bundle.puzzle);
+	if (limit) {
+		solutionsNum = calcSolutionsNumBounded(bundle.puzzle, (unsigned long) limit);
+	} else {
+		solutionsNum = calcSolutionsNum(bundle.puzzle, bundle.threadsNum);
+	}
 
-	printf(infoMsgSolutionsNum, solutionsNum);
+	if (limit && solutionsNum == (uint64_t) limit) {
+		printf(infoMsgSolutionsNumAtLeast, solutionsNum);
+	} else {
+		printf(infoMsgSolutionsNum, solutionsNum);
+	}
 
-	if (solutionsNum == 1) {
+	if (solutionsNum == 1 && limit != 1) {
 		printf("%s\n", infoMsgSingleSolution);
 	} else if (solutionsNum > 1) {
 		printf("%s\n", infoMsgMultipleSolutions);
@@ -467,6 +614,232 @@ static ParserFeedback numSolutionsOp(LinkedList* args) {
 #undef finish
 }
 
+/**
+ * The operation of the "count_resumable" command.
+ * It counts the solutions like "num_solutions", while checkpointing the search to a file
+ * once in SECONDS seconds and once in NODES search nodes (0 for none). If the file contains
+ * a checkpoint of the same board, the counting is resumed from it.
+ */
+static ParserFeedback countResumableOp(LinkedList* args) {
+#define finish returnGameMode(ret, getCurrentGameMode())
+	ParserFeedback ret;
+	int seconds = defaultCheckpointSeconds, nodes = 0;
+	unsigned long solutionsNum;
+	Bool resumed;
+	ResumableStatus status;
+	char *path = args->first->data;
+	const char *secondsArg = args->first->next->data, *nodesArg = args->first->next->next->data;
+
+	if (secondsArg) {
+		seconds = isUInteger(secondsArg);
+	}
+	if (nodesArg) {
+		nodes = isUInteger(nodesArg);
+	}
+	if (seconds < 0 || nodes < 0 || (!seconds && !nodes)) {
+		printf("%s\n", errMsgErroneousIntervalVal);
+		finish;
+	}
+
+	if (!isPuzzleLegal(bundle.puzzle)) {
+		printf("%s\n", errMsgErroneousValues);
+		finish;
+	}
+	if (bundle.puzzle->n * bundle.puzzle->m > maxMaskDim) {
+		printf("%s\n", errMsgBoardTooLarge);
+		finish;
+	}
+
+	status = calcSolutionsNumResumable(bundle.puzzle, path, (unsigned long) nodes, seconds, &solutionsNum, &resumed);
+	if (status == resumableNotCheckpoint) {
+		printf(errMsgNotCheckpoint, path);
+		finish;
+	}
+	if (status == resumableWriteFailed) {
+		printf("%s\n", errMsgIOCreationModFailed);
+	}
+	if (resumed) {
+		printf(infoMsgResumedFrom, path);
+	}
+	printf(infoMsgSolutionsNum, (uint64_t) solutionsNum);
+
+	finish;
+#undef finish
+}
+
+/**
+ * This struct is the argument of writeSolution.
+ */
+typedef struct {
+	FILE *fp;
+	unsigned int dim;
+
+	/**
+	 * TRUE iff every solution has been written successfully.
+	 */
+	Bool written;
+} SolutionsFile;
+
+/**
+ * This method is the onSolution function of the "enumerate" command, which writes
+ * a solution to a file in the compact format.
+ */
+static void writeSolution(const unsigned int *values, void *arg) {
+	SolutionsFile *file = arg;
+	if (file->written) {
+		file->written = writeCompactBoard(file->fp, file->dim, values);
+	}
+}
+
+/**
+ * The operation of the "enumerate" command.
+ * It streams the solutions (or the first ones) to a file, a single line per solution.
+ */
+static ParserFeedback enumerateOp(LinkedList* args) {
+#define finish returnGameMode(ret, getCurrentGameMode())
+	ParserFeedback ret;
+	int limit = 0;
+	unsigned long solutionsNum;
+	const char *path = args->first->data, *arg = args->first->next->data;
+	SolutionsFile file;
+
+	if (arg) {
+		limit = isUInteger(arg);
+		if (limit < 1) {
+			printf("%s\n", errMsgErroneousLimitVal);
+			finish;
+		}
+	}
+
+	if (!isPuzzleLegal(bundle.puzzle)) {
+		printf("%s\n", errMsgErroneousValues);
+		finish;
+	}
+	if (bundle.puzzle->n * bundle.puzzle->m > maxMaskDim) {
+		printf("%s\n", errMsgBoardTooLarge);
+		finish;
+	}
+
+	file.fp = fopen(path, "w");
+	if (!file.fp) {
+		printf("%s\n", errMsgIOCreationModFailed);
+		finish;
+	}
+	file.dim = bundle.puzzle->n * bundle.puzzle->m;
+	file.written = TRUE;
+
+	solutionsNum = enumerateSolutions(bundle.puzzle, limit ? (unsigned long) limit : ULONG_MAX, writeSolution, &file);
+
+	if (fclose(file.fp) || !file.written) {
+		printf("%s\n", errMsgIOCreationModFailed);
+	} else {
+		printf(infoMsgSolutionsWritten, solutionsNum, path);
+	}
+
+	finish;
+#undef finish
+}
+
+/**
+ * The operation of the "marginals" command.
+ * For every empty cell, it prints the number of the solutions that assign each value to it,
+ * and whether the cell is forced (it has the same value in all the solutions).
+ */
+static ParserFeedback marginalsOp(LinkedList* args) {
+#define finish returnGameMode(ret, getCurrentGameMode())
+	ParserFeedback ret;
+	int limit = 0;
+	unsigned int x, y, v, dim = bundle.puzzle->n * bundle.puzzle->m, values, forcedNum = 0;
+	unsigned long solutionsNum, *marginals, *cell;
+	const char *arg = args->first->data;
+
+	if (arg) {
+		limit = isUInteger(arg);
+		if (limit < 1) {
+			printf("%s\n", errMsgErroneousLimitVal);
+			finish;
+		}
+	}
+
+	if (!isPuzzleLegal(bundle.puzzle)) {
+		printf("%s\n", errMsgErroneousValues);
+		finish;
+	}
+	if (dim > maxMaskDim) {
+		printf("%s\n", errMsgBoardTooLarge);
+		finish;
+	}
+
+	memAllocN(marginals, unsigned long, dim * dim * dim);
+	solutionsNum = calcMarginals(bundle.puzzle, limit ? (unsigned long) limit : ULONG_MAX, marginals);
+
+	if (!solutionsNum) {
+		printf("%s\n", errMsgUnsolvablePuzzle);
+	} else {
+		if (limit && solutionsNum == (unsigned long) limit) {
+			printf(infoMsgMarginalsPartial, solutionsNum);
+		} else {
+			printf(infoMsgSolutionsNum, (uint64_t) solutionsNum);
+		}
+		for (x = 0; x < dim; x++) {
+			for (y = 0; y < dim; y++) {
+				if (getBoardValue(bundle.puzzle, x, y)) {
+					continue;
+				}
+				cell = marginals + (x * dim + y) * dim;
+				printf(infoMsgMarginalsCell, y + 1, x + 1);
+				for (v = 1, values = 0; v <= dim; v++) {
+					if (cell[v - 1]) {
+						printf(infoMsgMarginalsValue, v, cell[v - 1]);
+						values++;
+					}
+				}
+				if (values == 1) {
+					printf(" %s", infoMsgMarginalsForced);
+					forcedNum++;
+				}
+				printf("\n");
+			}
+		}
+		printf(infoMsgMarginalsForcedNum, forcedNum);
+	}
+
+	memFree(marginals);
+	finish;
+#undef finish
+}
+
+static ParserFeedback estimateSolutionsOp(LinkedList* args) {
+#define finish returnGameMode(ret, getCurrentGameMode())
+	ParserFeedback ret;
+	int samples = defaultEstimateSamples;
+	const char *arg = args->first->data;
+	CountEstimate estimate;
+
+	if (arg) {
+		samples = isUInteger(arg);
+		if (samples < 1) {
+			printf("%s\n", errMsgErroneousSamplesVal);
+			finish;
+		}
+	}
+
+	if (!isPuzzleLegal(bundle.puzzle)) {
+		printf("%s\n", errMsgErroneousValues);
+		finish;
+	}
+	if (bundle.puzzle->n * bundle.puzzle->m > maxMaskDim) {
+		printf("%s\n", errMsgBoardTooLarge);
+		finish;
+	}
+
+	estimateSolutionsNum(bundle.puzzle, (unsigned long) samples, estimateTimeBudget, &bundle.rng, &estimate);
+	printf(infoMsgSolutionsEstimate, estimate.estimate, estimate.low, estimate.high, estimate.samples);
+
+	finish;
+#undef finish
+}
+
 static ParserFeedback autofillOp(LinkedList* args) {
 #define finish(gamemode) returnGameMode(ret, gamemode)
 	ParserFeedback ret;
@@ -547,21 +920,29 @@ LinkedList* createCommandsList() {
 	EnumSubsetTurnOn(editMode, gameModeEdit);
 	EnumSubsetTurnOn(solveMode, gameModeSolve);
 
-	appendElemToList(commands, createListElem(createCommand(cmdNameSolve, 1, allModes, solveOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameEdit, 1, allModes, editOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameMarkErrors, 1, solveMode, markErrorsOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNamePrintBoard, 0, editSolveModes, printBoardOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameSet, 3, editSolveModes, setOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameValidate, 0, editSolveModes, validateOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameGenerate, 2, editMode, generateOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameUndo, 0, editSolveModes, undoOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameRedo, 0, editSolveModes, redoOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameSave, 1, editSolveModes, saveOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameHint, 2, solveMode, hintOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameNumSolutions, 0, editSolveModes, numSolutionsOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameAutofill, 0, solveMode, autofillOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameReset, 0, editSolveModes, resetOp)));
-	appendElemToList(commands, createListElem(createCommand(cmdNameExit, 0, allModes, exitOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameSolve, 1, 1, allModes, solveOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameEdit, 0, 1, allModes, editOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameMarkErrors, 1, 1, solveMode, markErrorsOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNamePrintBoard, 0, 0, editSolveModes, printBoardOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameSet, 3, 3, editSolveModes, setOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameValidate, 0, 0, editSolveModes, validateOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameGenerate, 2, 2, editMode, generateOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameBuildBank, 1, 1, editSolveModes, buildBankOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameGenerateUnique, 1, 2, editMode, generateUniqueOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameUndo, 0, 0, editSolveModes, undoOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameRedo, 0, 0, editSolveModes, redoOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameSave, 1, 1, editSolveModes, saveOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameHint, 2, 2, solveMode, hintOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameNumSolutions, 0, 1, editSolveModes, numSolutionsOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameCountResumable, 1, 3, editSolveModes, countResumableOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameEnumerate, 1, 2, editSolveModes, enumerateOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameMarginals, 0, 1, editSolveModes, marginalsOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameEstimateSolutions, 0, 1, editSolveModes, estimateSolutionsOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameThreads, 1, 1, allModes, threadsOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameSeed, 1, 1, allModes, seedOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameAutofill, 0, 0, solveMode, autofillOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameReset, 0, 0, editSolveModes, resetOp)));
+	appendElemToList(commands, createListElem(createCommand(cmdNameExit, 0, 0, allModes, exitOp)));
 
 	destroyEnumSubset(allModes);
 	destroyEnumSubset(editSolveModes);
@@ -587,5 +968,9 @@ void freeCommands(LinkedList* commands) {
 	forEachListElem(commands, destroyElemData);
 }
 
+#undef defaultEstimateSamples
+#undef estimateTimeBudget
+#undef defaultCheckpointSeconds
+#undef defaultGenerateUniqueSeconds
 #undef returnGameMode
 #undef checkGameEnd
\ No newline at end of file
@@ -63,7 +63,7 @@ static ParserFeedback analyseCommand(char *command) {
 
 			for (; j < currentCmd->argNum; j++) { /* collect the command's arguments from the user */
 				char *arg = strtok(NULL, delimiter);
-				if ((!arg || strlen(arg) == 0) && strcmp(command, cmdNameEdit) != 0) {
+				if ((!arg || strlen(arg) == 0) && j < currentCmd->minArgNum) {
 					destroyList(args);
 					illegalCmd;
 				}
@@ -108,10 +108,11 @@ ParserFeedback listen() {
 	return ret;
 }
 
-Command *createCommand(char *name, int argNum, EnumSubset *fromModes, ParserFeedback(*operate)(LinkedList *args)) {
+Command *createCommand(char *name, int minArgNum, int argNum, EnumSubset *fromModes, ParserFeedback(*operate)(LinkedList *args)) {
 	Command *memAlloc(res, Command);
 
 	res->name = copyString(name);
+	res->minArgNum = minArgNum;
 	res->argNum = argNum;
 	res->fromModes = cloneEnumSubset(fromModes);
 	res->operate = operate;
@@ -23,6 +23,11 @@ typedef struct {
 	 */
 	char *name;
 
+	/**
+	 * The number of the mandatory arguments.
+	 */
+	int minArgNum;
+
 	/**
 	 * The command's arity.
 	 */
@@ -41,7 +46,7 @@ typedef struct {
 	 *
 	 * Preconditions:
 	 * args != 0
-	 * The length of args <= argNum
+	 * The length of args == argNum. The data of a missing optional argument is 0.
 	 *
 	 * Returns:
 	 * ParserFeedback
@@ -54,12 +59,13 @@ typedef struct {
  *
  * Parameters:
  * char *name - The command's name
+ * int minArgNum - The number of the mandatory arguments, the rest are optional
  * int argNum - The command's arity
  * EnumSubset *fromModes - A non-empty subset from the GameMode enum that defines the modes in which this
  *		command is permitted. Note that the enum is cloned.
  * ParserFeedback (*operate)(LinkedList*) - The command's operation function as described in "Command" struct.
  */
-Command *createCommand(char *name, int argNum, EnumSubset *fromModes, ParserFeedback(*operate)(LinkedList *args));
+Command *createCommand(char *name, int minArgNum, int argNum, EnumSubset *fromModes, ParserFeedback(*operate)(LinkedList *args));
 
 /**
  * This method frees a command from the memory.
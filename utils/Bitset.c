@@ -0,0 +1,51 @@
+#include "Bitset.h"
+#include <assert.h>
+
+ValueMask fullBitsetWord(unsigned int dim, unsigned int w) {
+	if (dim <= w * maxMaskDim) {
+		return 0;
+	}
+	return dim - w * maxMaskDim >= maxMaskDim ? ~((ValueMask) 0) : fullMask(dim - w * maxMaskDim);
+}
+
+void fillBitset(ValueMask *set, unsigned int dim) {
+	unsigned int w;
+
+	for (w = 0; w < bitsetWords(dim); w++) {
+		set[w] = fullBitsetWord(dim, w);
+	}
+}
+
+void clearBitset(ValueMask *set, unsigned int words) {
+	unsigned int w;
+
+	for (w = 0; w < words; w++) {
+		set[w] = 0;
+	}
+}
+
+unsigned int countBitsetWords(const ValueMask *set, unsigned int words, unsigned int stride) {
+	unsigned int w, res = 0;
+
+	for (w = 0; w < words; w++) {
+		res += countValues(set[w * stride]);
+	}
+	return res;
+}
+
+unsigned int nthBitsetValue(const ValueMask *set, unsigned int words, unsigned int stride, unsigned int k) {
+	unsigned int w, cnt;
+	ValueMask word;
+
+	for (w = 0; w < words; w++) {
+		cnt = countValues(set[w * stride]);
+		if (k < cnt) {
+			for (word = set[w * stride]; k--; word &= word - 1) {
+			}
+			return w * maxMaskDim + lowestValue(word);
+		}
+		k -= cnt;
+	}
+	assert(FALSE);
+	return 0;
+}
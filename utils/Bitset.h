@@ -0,0 +1,70 @@
+#ifndef __UTILS_BITSET_H
+#define __UTILS_BITSET_H
+/**
+ * This module defines sets of sudoku values of any width, as arrays of ValueMask words:
+ * the value v is the bit (v - 1) % maxMaskDim of the word (v - 1) / maxMaskDim.
+ * A set of the values 1, ..., dim takes bitsetWords(dim) words, which is chosen once
+ * per board shape. For boards of n*m ≤ maxMaskDim a set is a single word, and
+ * countBitset takes the single-word fast path. The words of a set need not be adjacent:
+ * the methods that read a set take the stride between its words, so the candidates of
+ * the cells may be stored word by word (see CPEngine).
+ */
+
+#include "Boolean.h"
+#include "ValueMask.h"
+
+/**
+ * The number of the words of a set of the values 1, ..., dim.
+ */
+#define bitsetWords(dim) (((dim) + maxMaskDim - 1) / maxMaskDim)
+
+/**
+ * The index of the word of the value v, and its bit in that word (v ≥ 1).
+ */
+#define bitsetWord(v) (((v) - 1) / maxMaskDim)
+#define bitsetBit(v) valueBit(((v) - 1) % maxMaskDim + 1)
+
+/**
+ * The membership test, insertion and removal of the value v.
+ */
+#define hasBitsetValue(set, v) (((set)[bitsetWord(v)] & bitsetBit(v)) != 0)
+#define addBitsetValue(set, v) ((set)[bitsetWord(v)] |= bitsetBit(v))
+#define removeBitsetValue(set, v) ((set)[bitsetWord(v)] &= ~bitsetBit(v))
+
+/**
+ * The number of the values in a set of [words] words whose word w is set[w * stride].
+ * [set] and [words] are evaluated more than once.
+ */
+#define countBitset(set, words, stride) ((words) == 1 ? countValues(*(set)) \
+	: countBitsetWords(set, words, stride))
+
+/**
+ * This method returns the word w of the set of the values 1, ..., dim.
+ */
+ValueMask fullBitsetWord(unsigned int dim, unsigned int w);
+
+/**
+ * This method sets [set] to the values 1, ..., dim (bitsetWords(dim) words).
+ */
+void fillBitset(ValueMask *set, unsigned int dim);
+
+/**
+ * This method empties a set of [words] words.
+ */
+void clearBitset(ValueMask *set, unsigned int words);
+
+/**
+ * This method returns the number of the values in a set, see countBitset.
+ */
+unsigned int countBitsetWords(const ValueMask *set, unsigned int words, unsigned int stride);
+
+/**
+ * This method returns the value of a set whose index is k, in increasing order.
+ * The word w of the set is set[w * stride], see countBitset.
+ *
+ * Preconditions:
+ * k < countBitset(set, words, stride)
+ */
+unsigned int nthBitsetValue(const ValueMask *set, unsigned int words, unsigned int stride, unsigned int k);
+
+#endif
@@ -26,6 +26,14 @@
  */
 #define memAllocN(varName, type, n) varName = (type*) calloc(n, sizeof(type)); if (!varName) { fatalError("calloc"); }
 
+/**
+ * This macro should be used in order to allocate a variable named [varName] of type [type]
+ * that occupies [size] bytes (size >= sizeof(type)), e.g. a struct that is followed by its arrays.
+ * There is no initialization of the allocated bytes.
+ * Usage: [type] *memAllocSized([varName], [type], [size]);
+ */
+#define memAllocSized(varName, type, size) varName = (type*) malloc(size); if (!varName) { fatalError("malloc"); }
+
 /**
  * This macro should be used in order to free a dynamically allocated variable named [varName].
  * Preconditions: [varName] != 0
@@ -0,0 +1,59 @@
+#include "Rng.h"
+#include <assert.h>
+
+/**
+ * This macro rotates a 64-bit word left by k bits (0 < k < 64).
+ */
+#define rotl(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+void seedRng(Rng *rng, uint64_t seed) {
+	unsigned int k;
+	uint64_t z;
+
+	for (k = 0; k < 4; k++) { /* splitmix64 */
+		z = (seed += UINT64_C(0x9E3779B97F4A7C15));
+		z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+		z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+		rng->s[k] = z ^ (z >> 31);
+	}
+}
+
+uint64_t nextRng(Rng *rng) {
+	uint64_t *s = rng->s;
+	uint64_t res = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return res;
+}
+
+unsigned int rngBelow(Rng *rng, unsigned int bound) {
+	uint64_t r, limit;
+
+	assert(bound >= 1);
+	/* reject the values above the largest multiple of [bound], which would bias the result */
+	limit = UINT64_MAX - UINT64_MAX % bound;
+	do {
+		r = nextRng(rng);
+	} while (r >= limit);
+
+	return (unsigned int) (r % bound);
+}
+
+void rngShuffle(Rng *rng, unsigned int *arr, unsigned int len) {
+	unsigned int k, t, tmp;
+
+	for (k = len; k > 1; k--) {
+		t = rngBelow(rng, k);
+		tmp = arr[k - 1];
+		arr[k - 1] = arr[t];
+		arr[t] = tmp;
+	}
+}
+
+#undef rotl
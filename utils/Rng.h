@@ -0,0 +1,63 @@
+#ifndef __UTILS_RNG_H
+#define __UTILS_RNG_H
+/**
+ * This module defines a seedable pseudo random number generator (xoshiro256**).
+ * Its state is an explicit object, so every thread may own a generator, and a
+ * sequence of random choices is reproducible from its seed.
+ */
+
+#include <stdint.h>
+
+/**
+ * The state of a generator.
+ */
+typedef struct {
+	uint64_t s[4];
+} Rng;
+
+/**
+ * This method seeds a generator. The state is expanded from the seed by splitmix64,
+ * so close seeds yield unrelated sequences.
+ *
+ * Parameters:
+ * Rng *rng
+ * uint64_t seed
+ *
+ * Preconditions:
+ * rng != 0
+ */
+void seedRng(Rng *rng, uint64_t seed);
+
+/**
+ * This method returns the next 64 random bits of a generator.
+ *
+ * Preconditions:
+ * rng != 0
+ * [rng] has been seeded
+ */
+uint64_t nextRng(Rng *rng);
+
+/**
+ * This method returns a uniformly distributed integer in the range 0, ..., bound - 1.
+ *
+ * Preconditions:
+ * rng != 0
+ * bound ≥ 1
+ */
+unsigned int rngBelow(Rng *rng, unsigned int bound);
+
+/**
+ * This method shuffles an array uniformly (Fisher-Yates).
+ *
+ * Parameters:
+ * Rng *rng
+ * unsigned int *arr
+ * unsigned int len - The length of [arr]
+ *
+ * Preconditions:
+ * rng != 0
+ * arr != 0 ∨ len == 0
+ */
+void rngShuffle(Rng *rng, unsigned int *arr, unsigned int len);
+
+#endif
@@ -26,4 +26,26 @@ signed int isUInteger(const char *str) {
 	}
 
 	return res;
-}
\ No newline at end of file
+}
+
+Bool isUInteger64(const char *str, uint64_t *value) {
+	uint64_t res = 0;
+	unsigned int digit;
+
+	if (!*str) {
+		return FALSE;
+	}
+	for (; *str; str++) {
+		if (!isdigit(*str)) {
+			return FALSE;
+		}
+		digit = *str - '0';
+		if (res > (((uint64_t) -1) - digit) / 10) { /* res * 10 + digit overflows */
+			return FALSE;
+		}
+		res = res * 10 + digit;
+	}
+
+	*value = res;
+	return TRUE;
+}
@@ -1,6 +1,7 @@
 #ifndef __UTILS_STRINGS_H
 #define __UTILS_STRINGS_H
 
+#include <stdint.h>
 #include "Boolean.h"
 
 /**
@@ -36,4 +37,21 @@ char *copyString(const char *str);
  */
 signed int isUInteger(const char *str);
 
+/**
+ * This method receives a string and checks whether it represents a (decimal) unsigned integer
+ * that fits in 64 bits. If it does, it stores that integer in [value].
+ *
+ * Parameters:
+ * const char *str
+ * uint64_t *value - The parsed integer, left unchanged if the string is not such an integer
+ *
+ * Preconditions:
+ * str != NULL
+ * value != NULL
+ *
+ * Returns:
+ * TRUE iff the string represents an unsigned integer below 2^64.
+ */
+Bool isUInteger64(const char *str, uint64_t *value);
+
 #endif
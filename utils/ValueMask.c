@@ -0,0 +1,28 @@
+#include "ValueMask.h"
+#include <assert.h>
+
+ValueMask fullMask(unsigned int dim) {
+	assert(dim <= maxMaskDim);
+	return dim == maxMaskDim ? ~((ValueMask) 0) : valueBit(dim + 1) - 1;
+}
+
+#ifndef __GNUC__
+
+unsigned int countValues(ValueMask mask) {
+	unsigned int res = 0;
+	for (; mask; mask &= mask - 1) {
+		res++;
+	}
+	return res;
+}
+
+unsigned int lowestValue(ValueMask mask) {
+	unsigned int res = 1;
+	assert(mask != 0);
+	for (; !(mask & 1); mask >>= 1) {
+		res++;
+	}
+	return res;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __UTILS_VALUEMASK_H
+#define __UTILS_VALUEMASK_H
+/**
+ * This module defines the ValueMask type, a set of sudoku values that fits
+ * in a single machine word, and reusable operations on it.
+ */
+
+#include <limits.h>
+
+/**
+ * A set of values of a puzzle: the bit (v - 1) is on iff the value v is
+ * contained in the set.
+ */
+typedef unsigned long ValueMask;
+
+/**
+ * The maximal n*m for which the values of a puzzle fit in a ValueMask.
+ */
+#define maxMaskDim (sizeof(ValueMask) * CHAR_BIT)
+
+/**
+ * The mask that contains only the value v (1 ≤ v ≤ maxMaskDim).
+ */
+#define valueBit(v) (((ValueMask) 1) << ((v) - 1))
+
+/**
+ * This method returns the mask that contains the values 1, ..., dim.
+ *
+ * Preconditions:
+ * dim ≤ maxMaskDim
+ */
+ValueMask fullMask(unsigned int dim);
+
+#ifdef __GNUC__
+
+/**
+ * The number of the values in [mask].
+ */
+#define countValues(mask) ((unsigned int) __builtin_popcountl(mask))
+
+/**
+ * The minimal value in [mask] (mask != 0).
+ */
+#define lowestValue(mask) ((unsigned int) __builtin_ctzl(mask) + 1)
+
+#else
+
+/**
+ * This method returns the number of the values in [mask].
+ */
+unsigned int countValues(ValueMask mask);
+
+/**
+ * This method returns the minimal value in [mask].
+ *
+ * Preconditions:
+ * mask != 0
+ */
+unsigned int lowestValue(ValueMask mask);
+
+#endif
+
+#endif